@@ -0,0 +1,212 @@
+#ifndef STRUCTURES_ADDRESSABLE_HEAP_H
+#define STRUCTURES_ADDRESSABLE_HEAP_H
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+
+#include <array_list.h>
+#include <traits.h>
+
+namespace structures {
+
+/**
+ * @brief A Heap whose elements can be changed or removed while in it
+ *
+ * @details push returns a handle to the element, and the handle gives
+ * access to the element until it is popped or erased: its value can be read,
+ * changed with decrease_key or increase_key, or the element erased, all in
+ * logarithmic time. This replaces pushing a new copy of an element whose
+ * priority changed and skipping the stale copies when they are popped, which
+ * makes the heap several times larger.
+ *
+ * It is a d-ary heap like HeapWrapper, plus an array from handles to heap
+ * positions that the sifts keep up to date. Handles are small integers, and
+ * the handle of a popped or erased element is reused by a later push.
+ *
+ * @tparam          T Data type of the elements
+ * @tparam Comparator Type providing a strict weak ordering function
+ * @tparam      Arity Amount of children of each node
+ */
+template <
+	typename T, typename Comparator = std::less<T>, std::size_t Arity = 4>
+class AddressableHeapWrapper {
+	static_assert(Arity >= 2, "a heap node needs at least two children");
+
+public:
+	using Handle = std::size_t;
+
+	/**
+	 * @brief Inserts an element into the Heap
+	 *
+	 * @return The handle of the element
+	 */
+	Handle push(const T& data) { return push(T(data)); }
+
+	Handle push(T&& data) {
+		Handle handle;
+		if (free_handles.empty()) {
+			handle = positions.size();
+			positions.push_back(list.size());
+		} else {
+			handle = free_handles.pop_back();
+			positions[handle] = list.size();
+		}
+		list.push_back(Node{std::move(data), handle});
+		sift_up(list.size() - 1);
+		return handle;
+	}
+
+	/**
+	 * @brief Removes the top, i.e. the larger, element of the Heap
+	 *
+	 * @return The removed element
+	 */
+	T pop() { return erase(list[0].handle); }
+
+	/**
+	 * @brief Removes the element of `handle` from the Heap
+	 *
+	 * @return The removed element
+	 */
+	T erase(Handle handle) {
+		std::size_t i = positions[handle];
+		T out = std::move(list[i].data);
+		positions[handle] = npos;
+		free_handles.push_back(handle);
+
+		Node last = list.pop_back();
+		if (i < list.size()) {
+			list[i] = std::move(last);
+			restore(i);
+		}
+		return out;
+	}
+
+	/**
+	 * @brief Replaces the value of `handle` with a smaller one, e.g. a
+	 * shorter distance
+	 *
+	 * @details The element moves in whichever direction the Comparator
+	 * requires, so a larger value is handled correctly too.
+	 */
+	void decrease_key(Handle handle, T data) {
+		update(handle, std::move(data));
+	}
+
+	/**
+	 * @brief Replaces the value of `handle` with a larger one
+	 *
+	 * @details As decrease_key, the element moves in whichever direction the
+	 * Comparator requires.
+	 */
+	void increase_key(Handle handle, T data) {
+		update(handle, std::move(data));
+	}
+
+	/**
+	 * @brief Returns true if the element of `handle` is in the Heap
+	 */
+	bool contains(Handle handle) const {
+		return handle < positions.size() && positions[handle] != npos;
+	}
+
+	/**
+	 * @brief const ref to the element of `handle`
+	 */
+	const T& value(Handle handle) const { return list[positions[handle]].data; }
+
+	void clear() {
+		list.clear();
+		positions.clear();
+		free_handles.clear();
+	}
+
+	/**
+	 * @brief const ref to the top element of the Heap
+	 */
+	const T& top() const { return list[0].data; }
+
+	/**
+	 * @brief The handle of the top element of the Heap
+	 */
+	Handle top_handle() const { return list[0].handle; }
+
+	std::size_t size() const { return list.size(); }
+
+private:
+	struct Node {
+		T data;
+		Handle handle;
+	};
+
+	constexpr static std::size_t npos = ~std::size_t{0};
+
+	void update(Handle handle, T&& data) {
+		std::size_t i = positions[handle];
+		list[i].data = std::move(data);
+		restore(i);
+	}
+
+	// moves the element at `i` up or down, wherever the order requires
+	void restore(std::size_t i) {
+		if (i > 0 && comp(list[(i - 1) / Arity].data, list[i].data))
+			sift_up(i);
+		else
+			sift_down(i);
+	}
+
+	void sift_up(std::size_t i) {
+		Node node = std::move(list[i]);
+		while (i > 0) {
+			std::size_t parent = (i - 1) / Arity;
+			if (!comp(list[parent].data, node.data))
+				break;
+			move_to(i, std::move(list[parent]));
+			i = parent;
+		}
+		move_to(i, std::move(node));
+	}
+
+	void sift_down(std::size_t i) {
+		const std::size_t size = list.size();
+		Node node = std::move(list[i]);
+		while (true) {
+			std::size_t first = Arity * i + 1;
+			if (first >= size)
+				break;
+			std::size_t last = first + Arity < size ? first + Arity : size;
+			std::size_t larger = first;
+			for (std::size_t c = first + 1; c < last; c++)
+				if (comp(list[larger].data, list[c].data))
+					larger = c;
+			if (!comp(node.data, list[larger].data))
+				break;
+			move_to(i, std::move(list[larger]));
+			i = larger;
+		}
+		move_to(i, std::move(node));
+	}
+
+	void move_to(std::size_t i, Node&& node) {
+		positions[node.handle] = i;
+		list[i] = std::move(node);
+	}
+
+	ArrayList<Node> list;
+	ArrayList<std::size_t> positions;  // of each handle in `list`
+	ArrayList<Handle> free_handles;
+	Comparator comp;
+};
+
+template <typename T>
+class AddressableHeap : public AddressableHeapWrapper<T> {};
+
+}  // namespace structures
+
+/* name trait */
+template <>
+const std::string traits::type<structures::AddressableHeap>::name =
+	"AddressableHeap";
+
+#endif
@@ -4,6 +4,7 @@
 #include <cstdint>
 #include <memory>
 #include <stdexcept>
+#include <utility>
 
 #include <traits.h>
 #include <utils.h>
@@ -64,6 +65,15 @@ public:
 	 */
 	void clear() { size_ = 0; }
 
+	/**
+	 * @brief Makes room for `capacity` elements, so that adding up to that
+	 * many does not reallocate
+	 */
+	void reserve(std::size_t capacity) {
+		if (capacity >= max_size_)
+			reallocate(capacity + 1);
+	}
+
 	/**
 	 * @brief Adds 'data' to the end of the list
 	 *
@@ -71,6 +81,8 @@ public:
 	 */
 	void push_back(const T& data) { insert(data, size_); }
 
+	void push_back(T&& data) { insert(std::move(data), size_); }
+
 	/**
 	 * @brief Adds 'data' to the beginning of the list
 	 *
@@ -84,19 +96,10 @@ public:
 	 * @param data The element that'll be inserted
 	 * @param index The position where 'data' will be inserted
 	 */
-	void insert(const T& data, std::size_t index) {
-		if (index > size_) {
-			throw std::out_of_range("Index out of bounds");
-		} else {
-			for (std::size_t i = size_; i > index; i--) {
-				contents[i] = contents[i - 1];
-			}
-			contents[index] = data;
-			size_++;
+	void insert(const T& data, std::size_t index) { insert_at(data, index); }
 
-			if (max_size_ == size_)
-				expand(2);
-		}
+	void insert(T&& data, std::size_t index) {
+		insert_at(std::move(data), index);
 	}
 
 	/**
@@ -124,9 +127,9 @@ public:
 		} else if (index >= size_) {
 			throw std::out_of_range("Index out of bounds");
 		} else {
-			T deleted = contents[index];
+			T deleted = std::move(contents[index]);
 			for (std::size_t i = index; i < size_ - 1; ++i) {
-				contents[i] = contents[i + 1];
+				contents[i] = std::move(contents[i + 1]);
 			}
 			size_--;
 
@@ -241,9 +244,32 @@ public:
 	const T& back() const { return contents[size_ - 1]; }
 
 private:
-	void expand(float ratio) {
-		contents = copy_array(contents, size_, max_size_ * ratio);
-		max_size_ *= ratio;
+	// elements are moved, never copied, to make room
+	template <typename U>
+	void insert_at(U&& data, std::size_t index) {
+		if (index > size_) {
+			throw std::out_of_range("Index out of bounds");
+		} else {
+			for (std::size_t i = size_; i > index; i--) {
+				contents[i] = std::move(contents[i - 1]);
+			}
+			contents[index] = std::forward<U>(data);
+			size_++;
+
+			if (max_size_ == size_)
+				expand(2);
+		}
+	}
+
+	void expand(float ratio) { reallocate(max_size_ * ratio); }
+
+	void reallocate(std::size_t new_size) {
+		std::unique_ptr<T[]> moved{new T[new_size]};
+		for (std::size_t i = 0; i < size_; i++) {
+			moved[i] = std::move(contents[i]);
+		}
+		contents = std::move(moved);
+		max_size_ = new_size;
 	}
 
 	static std::unique_ptr<T[]> copy_array(
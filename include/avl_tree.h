@@ -52,6 +52,10 @@ public:
 		return parent;
 	}
 
+	static void settle(AVLNode<T>* n, std::size_t, std::size_t) {
+		updateHeight(n);
+	}
+
 private:
 	static void updateHeight(AVLNode<T>* n) {
 		if (n) {
@@ -160,6 +164,10 @@ class AVLTree : public Tree<T, AVLNode<T>> {};
 template <>
 const bool traits::is_set<structures::AVLTree>::value = true;
 
+/* tree trait */
+template <>
+const bool traits::is_tree<structures::AVLTree>::value = true;
+
 /* name trait */
 template <>
 const std::string traits::type<structures::AVLTree>::name = "AVLTree";
@@ -0,0 +1,513 @@
+#ifndef STRUCTURES_B_PLUS_TREE_H
+#define STRUCTURES_B_PLUS_TREE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+#include <array_list.h>
+#include <traits.h>
+
+namespace structures {
+
+/**
+ * @brief B+ tree set implementation
+ *
+ * @details Each node of this tree holds many keys in a contiguous array, so
+ * a lookup touches one or two cache lines per level instead of one per key,
+ * and the tree is only O(log_B n) levels deep. All the elements are stored
+ * in the leaves, which are linked to their siblings, so iterating over the
+ * elements (or over a range of them) is a sequential scan.
+ *
+ * Searches inside a node count the keys that are smaller than the searched
+ * one without branching on the comparisons, which compilers turn into SIMD
+ * comparisons for arithmetic types.
+ *
+ * @tparam T         Data type of the elements
+ * @tparam NodeBytes Approximate size, in bytes, of each node
+ */
+template <typename T, std::size_t NodeBytes = 256>
+class BPlusTreeWrapper {
+	struct Node;
+	struct Leaf;
+	struct Inner;
+
+public:
+	BPlusTreeWrapper() = default;
+
+	BPlusTreeWrapper(const BPlusTreeWrapper<T, NodeBytes>& other) {
+		auto list = other.items();
+		assign_sorted(list);
+	}
+
+	BPlusTreeWrapper(BPlusTreeWrapper<T, NodeBytes>&& other)
+		: root{other.root}, size_{other.size_} {
+		other.root = nullptr;
+		other.size_ = 0;
+	}
+
+	BPlusTreeWrapper<T, NodeBytes>& operator=(
+		const BPlusTreeWrapper<T, NodeBytes>& other) {
+		BPlusTreeWrapper<T, NodeBytes> copy{other};
+		std::swap(root, copy.root);
+		std::swap(size_, copy.size_);
+		return *this;
+	}
+
+	BPlusTreeWrapper<T, NodeBytes>& operator=(
+		BPlusTreeWrapper<T, NodeBytes>&& other) {
+		BPlusTreeWrapper<T, NodeBytes> copy{std::move(other)};
+		std::swap(root, copy.root);
+		std::swap(size_, copy.size_);
+		return *this;
+	}
+
+	~BPlusTreeWrapper() { destroy(root); }
+
+	/**
+	 * @brief Inserts `data` into the tree
+	 *
+	 * @return false if `data` was already in the tree, otherwise true
+	 */
+	bool insert(const T& data) {
+		if (root == nullptr)
+			root = new Leaf;
+
+		Split split;
+		if (!insert(root, data, split))
+			return false;
+
+		if (split.right) {
+			auto new_root = new Inner;
+			new_root->count = 1;
+			new_root->keys[0] = split.key;
+			new_root->children[0] = root;
+			new_root->children[1] = split.right;
+			root = new_root;
+		}
+
+		++size_;
+		return true;
+	}
+
+	/**
+	 * @brief Removes `data` from the tree
+	 *
+	 * @return false if `data` was not in the tree, otherwise true
+	 */
+	bool remove(const T& data) {
+		if (root == nullptr || !remove(root, data))
+			return false;
+
+		if (root->count == 0) {
+			Node* old_root = root;
+			root = root->leaf ? nullptr : ((Inner*) root)->children[0];
+			delete_node(old_root);
+		}
+
+		--size_;
+		return true;
+	}
+
+	/**
+	 * @brief Returns true if the tree contains `data`
+	 */
+	bool contains(const T& data) const {
+		if (root == nullptr)
+			return false;
+		const Leaf* leaf = find_leaf(data);
+		std::size_t i = rank(leaf->keys, leaf->count, data);
+		return i < leaf->count && !(data < leaf->keys[i]);
+	}
+
+	void clear() {
+		destroy(root);
+		root = nullptr;
+		size_ = 0;
+	}
+
+	std::size_t size() const { return size_; }
+
+	/**
+	 * @brief Returns the elements of the tree, in order
+	 */
+	ArrayList<T> items() const {
+		ArrayList<T> out{size_ + 1};
+		if (root) {
+			for (const Leaf* l = first_leaf(); l; l = l->next)
+				for (std::size_t i = 0; i < l->count; i++)
+					out.push_back(l->keys[i]);
+		}
+		return out;
+	}
+
+	/**
+	 * @brief Returns, in order, the elements `x` such that lo <= x < hi
+	 */
+	ArrayList<T> range(const T& lo, const T& hi) const {
+		ArrayList<T> out;
+		if (root == nullptr)
+			return out;
+
+		const Leaf* l = find_leaf(lo);
+		for (std::size_t i = rank(l->keys, l->count, lo); l; l = l->next) {
+			for (; i < l->count; i++) {
+				if (!(l->keys[i] < hi))
+					return out;
+				out.push_back(l->keys[i]);
+			}
+			i = 0;
+		}
+		return out;
+	}
+
+	/**
+	 * @brief Replaces the contents of the tree with a sorted list, in O(n)
+	 *
+	 * @param sorted A list in strictly increasing order
+	 */
+	void assign_sorted(const ArrayList<T>& sorted) {
+		clear();
+		if (sorted.size() == 0)
+			return;
+
+		// leaves are filled evenly, so all of them are at least half full
+		std::size_t leaves = (sorted.size() + leaf_capacity - 1) /
+							 leaf_capacity;
+		ArrayList<std::pair<Node*, T>> level{leaves + 1};
+		Leaf* prev = nullptr;
+		for (std::size_t i = 0, k = 0; i < leaves; i++) {
+			auto leaf = new Leaf;
+			leaf->count = share(sorted.size(), leaves, i);
+			for (std::size_t j = 0; j < leaf->count; j++)
+				leaf->keys[j] = sorted[k++];
+			leaf->prev = prev;
+			if (prev)
+				prev->next = leaf;
+			prev = leaf;
+			level.push_back({leaf, leaf->keys[0]});
+		}
+
+		while (level.size() > 1) {
+			std::size_t parents = (level.size() + inner_capacity) /
+								  (inner_capacity + 1);
+			ArrayList<std::pair<Node*, T>> up{parents + 1};
+			for (std::size_t i = 0, k = 0; i < parents; i++) {
+				auto inner = new Inner;
+				std::size_t children = share(level.size(), parents, i);
+				inner->count = children - 1;
+				up.push_back({inner, level[k].second});
+				inner->children[0] = level[k++].first;
+				for (std::size_t j = 1; j < children; j++) {
+					inner->keys[j - 1] = level[k].second;
+					inner->children[j] = level[k++].first;
+				}
+			}
+			level = std::move(up);
+		}
+
+		root = level[0].first;
+		size_ = sorted.size();
+	}
+
+private:
+	struct Node {
+		explicit Node(bool leaf_) : leaf{leaf_} {}
+
+		std::size_t count{0u};
+		bool leaf;
+	};
+
+	/*
+	 * Nodes have room for one extra key (and child), so an insertion can
+	 * overflow a node before it is split.
+	 */
+	static constexpr std::size_t fit(std::size_t bytes, std::size_t each) {
+		return bytes / each > 5 ? bytes / each - 1 : 4;
+	}
+
+	static_assert(
+		NodeBytes >= sizeof(Node) + 2 * sizeof(void*) + 4 * sizeof(T),
+		"NodeBytes is too small for this type");
+
+	static constexpr std::size_t leaf_capacity =
+		fit(NodeBytes - sizeof(Node) - 2 * sizeof(void*), sizeof(T));
+	static constexpr std::size_t inner_capacity =
+		fit(NodeBytes - sizeof(Node) - sizeof(void*),
+			sizeof(T) + sizeof(void*));
+
+	struct Leaf : Node {
+		Leaf() : Node{true} {}
+
+		T keys[leaf_capacity + 1];
+		Leaf* prev{nullptr};
+		Leaf* next{nullptr};
+	};
+
+	struct Inner : Node {
+		Inner() : Node{false} {}
+
+		T keys[inner_capacity + 1];
+		Node* children[inner_capacity + 2];
+	};
+
+	struct Split {
+		T key{};
+		Node* right{nullptr};
+	};
+
+	// size of the i-th of `parts` even parts of `total`
+	static std::size_t share(
+		std::size_t total, std::size_t parts, std::size_t i) {
+		return total / parts + (i < total % parts ? 1 : 0);
+	}
+
+	// amount of keys smaller than `data`, without branches
+	static std::size_t rank(const T* keys, std::size_t n, const T& data) {
+		std::size_t r = 0;
+		for (std::size_t i = 0; i < n; i++)
+			r += keys[i] < data;
+		return r;
+	}
+
+	// child of an inner node that may contain `data`
+	static std::size_t child_index(const Inner* n, const T& data) {
+		std::size_t r = 0;
+		for (std::size_t i = 0; i < n->count; i++)
+			r += !(data < n->keys[i]);
+		return r;
+	}
+
+	const Leaf* find_leaf(const T& data) const {
+		const Node* n = root;
+		while (!n->leaf) {
+			auto inner = (const Inner*) n;
+			n = inner->children[child_index(inner, data)];
+		}
+		return (const Leaf*) n;
+	}
+
+	const Leaf* first_leaf() const {
+		const Node* n = root;
+		while (!n->leaf)
+			n = ((const Inner*) n)->children[0];
+		return (const Leaf*) n;
+	}
+
+	static bool insert(Node* node, const T& data, Split& split) {
+		if (node->leaf) {
+			auto leaf = (Leaf*) node;
+			std::size_t i = rank(leaf->keys, leaf->count, data);
+			if (i < leaf->count && !(data < leaf->keys[i]))
+				return false;
+			insert_at(leaf->keys, leaf->count, i, data);
+			if (++leaf->count > leaf_capacity)
+				split_leaf(leaf, split);
+			return true;
+		}
+
+		auto inner = (Inner*) node;
+		std::size_t i = child_index(inner, data);
+		Split child;
+		if (!insert(inner->children[i], data, child))
+			return false;
+
+		if (child.right) {
+			insert_at(inner->keys, inner->count, i, child.key);
+			insert_at(inner->children, inner->count + 1, i + 1, child.right);
+			if (++inner->count > inner_capacity)
+				split_inner(inner, split);
+		}
+		return true;
+	}
+
+	template <typename U>
+	static void insert_at(U* array, std::size_t n, std::size_t i, const U& x) {
+		for (std::size_t j = n; j > i; j--)
+			array[j] = std::move(array[j - 1]);
+		array[i] = x;
+	}
+
+	template <typename U>
+	static void erase_at(U* array, std::size_t n, std::size_t i) {
+		for (std::size_t j = i; j + 1 < n; j++)
+			array[j] = std::move(array[j + 1]);
+	}
+
+	static void split_leaf(Leaf* leaf, Split& split) {
+		auto right = new Leaf;
+		std::size_t half = leaf->count / 2;
+		right->count = leaf->count - half;
+		std::move(leaf->keys + half, leaf->keys + leaf->count, right->keys);
+		leaf->count = half;
+
+		right->next = leaf->next;
+		right->prev = leaf;
+		if (leaf->next)
+			leaf->next->prev = right;
+		leaf->next = right;
+
+		split.key = right->keys[0];
+		split.right = right;
+	}
+
+	static void split_inner(Inner* inner, Split& split) {
+		auto right = new Inner;
+		std::size_t half = inner->count / 2;
+		right->count = inner->count - half - 1;
+		std::move(
+			inner->keys + half + 1, inner->keys + inner->count, right->keys);
+		std::move(
+			inner->children + half + 1, inner->children + inner->count + 1,
+			right->children);
+		split.key = std::move(inner->keys[half]);
+		split.right = right;
+		inner->count = half;
+	}
+
+	static bool remove(Node* node, const T& data) {
+		if (node->leaf) {
+			auto leaf = (Leaf*) node;
+			std::size_t i = rank(leaf->keys, leaf->count, data);
+			if (i == leaf->count || data < leaf->keys[i])
+				return false;
+			erase_at(leaf->keys, leaf->count--, i);
+			return true;
+		}
+
+		auto inner = (Inner*) node;
+		std::size_t i = child_index(inner, data);
+		if (!remove(inner->children[i], data))
+			return false;
+
+		Node* child = inner->children[i];
+		std::size_t min = child->leaf ? leaf_capacity / 2 : inner_capacity / 2;
+		if (child->count < min)
+			rebalance(inner, i);
+		return true;
+	}
+
+	// fixes the underflow of the i-th child of `parent`
+	static void rebalance(Inner* parent, std::size_t i) {
+		std::size_t min = parent->children[i]->leaf ? leaf_capacity / 2 :
+													  inner_capacity / 2;
+
+		if (i > 0 && parent->children[i - 1]->count > min) {
+			borrow_from_left(parent, i);
+		} else if (
+			i < parent->count && parent->children[i + 1]->count > min) {
+			borrow_from_right(parent, i);
+		} else if (i > 0) {
+			merge(parent, i - 1);
+		} else {
+			merge(parent, i);
+		}
+	}
+
+	static void borrow_from_left(Inner* parent, std::size_t i) {
+		Node* left = parent->children[i - 1];
+		Node* node = parent->children[i];
+
+		if (node->leaf) {
+			auto l = (Leaf*) left;
+			auto n = (Leaf*) node;
+			insert_at(n->keys, n->count++, 0, l->keys[--l->count]);
+			parent->keys[i - 1] = n->keys[0];
+		} else {
+			auto l = (Inner*) left;
+			auto n = (Inner*) node;
+			insert_at(n->keys, n->count, 0, parent->keys[i - 1]);
+			insert_at(n->children, n->count + 1, 0, l->children[l->count]);
+			++n->count;
+			parent->keys[i - 1] = l->keys[--l->count];
+		}
+	}
+
+	static void borrow_from_right(Inner* parent, std::size_t i) {
+		Node* node = parent->children[i];
+		Node* right = parent->children[i + 1];
+
+		if (node->leaf) {
+			auto n = (Leaf*) node;
+			auto r = (Leaf*) right;
+			n->keys[n->count++] = r->keys[0];
+			erase_at(r->keys, r->count--, 0);
+			parent->keys[i] = r->keys[0];
+		} else {
+			auto n = (Inner*) node;
+			auto r = (Inner*) right;
+			n->keys[n->count] = parent->keys[i];
+			n->children[++n->count] = r->children[0];
+			parent->keys[i] = r->keys[0];
+			erase_at(r->keys, r->count, 0);
+			erase_at(r->children, r->count + 1, 0);
+			--r->count;
+		}
+	}
+
+	// merges the (i+1)-th child of `parent` into the i-th one
+	static void merge(Inner* parent, std::size_t i) {
+		Node* left = parent->children[i];
+		Node* right = parent->children[i + 1];
+
+		if (left->leaf) {
+			auto l = (Leaf*) left;
+			auto r = (Leaf*) right;
+			std::move(r->keys, r->keys + r->count, l->keys + l->count);
+			l->count += r->count;
+			l->next = r->next;
+			if (r->next)
+				r->next->prev = l;
+		} else {
+			auto l = (Inner*) left;
+			auto r = (Inner*) right;
+			l->keys[l->count] = parent->keys[i];
+			std::move(r->keys, r->keys + r->count, l->keys + l->count + 1);
+			std::move(
+				r->children, r->children + r->count + 1,
+				l->children + l->count + 1);
+			l->count += r->count + 1;
+		}
+
+		erase_at(parent->keys, parent->count, i);
+		erase_at(parent->children, parent->count + 1, i + 1);
+		--parent->count;
+		delete_node(right);
+	}
+
+	static void delete_node(Node* n) {
+		if (n->leaf)
+			delete (Leaf*) n;
+		else
+			delete (Inner*) n;
+	}
+
+	static void destroy(Node* n) {
+		if (n == nullptr)
+			return;
+		if (!n->leaf) {
+			auto inner = (Inner*) n;
+			for (std::size_t i = 0; i <= inner->count; i++)
+				destroy(inner->children[i]);
+		}
+		delete_node(n);
+	}
+
+	Node* root{nullptr};
+	std::size_t size_{0u};
+};
+
+template <typename T>
+class BPlusTree : public BPlusTreeWrapper<T> {};
+
+}  // namespace structures
+
+/* set trait */
+template <>
+const bool traits::is_set<structures::BPlusTree>::value = true;
+
+/* name trait */
+template <>
+const std::string traits::type<structures::BPlusTree>::name = "BPlusTree";
+
+#endif
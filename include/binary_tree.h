@@ -20,30 +20,28 @@ struct Node {
 
 	Node(const T& data_, Node* parent_) : data{data_}, parent{parent_} {}
 
-	virtual ~Node() {
-		delete left;
-		delete right;
-	}
+	// children are not deleted, Tree::destroy() deletes whole subtrees
+	virtual ~Node() = default;
 
 	static Node<T>* insert(Node<T>* node, const T& data_) {
-		if (data_ < node->data) {
-			// insert left
-			if (node->left) {
-				return insert(node->left, data_);
-			} else {
-				node->left = new Node(data_, node);
-				return node->left;
-			}
-		} else if (data_ > node->data) {
-			// insert right
-			if (node->right) {
-				return insert(node->right, data_);
+		while (true) {
+			if (data_ < node->data) {
+				// insert left
+				if (!node->left) {
+					node->left = new Node(data_, node);
+					return node->left;
+				}
+				node = node->left;
+			} else if (data_ > node->data) {
+				// insert right
+				if (!node->right) {
+					node->right = new Node(data_, node);
+					return node->right;
+				}
+				node = node->right;
 			} else {
-				node->right = new Node(data_, node);
-				return node->right;
+				return nullptr;
 			}
-		} else {
-			return nullptr;
 		}
 	}
 
@@ -64,9 +62,6 @@ struct Node {
 				if (n)
 					n->parent = node->parent;
 
-				node->left = nullptr;
-				node->right = nullptr;
-
 				auto parent = node->parent;
 				delete node;
 				return parent;
@@ -77,6 +72,9 @@ struct Node {
 		}
 	}
 
+	// sets balancing information of a node built by Tree::assign_sorted
+	static void settle(Node<T>*, std::size_t, std::size_t) {}
+
 	bool contains(const T& data_) const {
 		if (data == data_) {
 			return true;
@@ -171,6 +169,10 @@ class BinaryTree : public Tree<T, Node<T>> {};
 template <>
 const bool traits::is_set<structures::BinaryTree>::value = true;
 
+/* tree trait */
+template <>
+const bool traits::is_tree<structures::BinaryTree>::value = true;
+
 /* name trait */
 template <>
 const std::string traits::type<structures::BinaryTree>::name = "BinaryTree";
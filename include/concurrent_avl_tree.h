@@ -0,0 +1,711 @@
+#ifndef STRUCTURES_CONCURRENT_AVL_TREE_H
+#define STRUCTURES_CONCURRENT_AVL_TREE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+#include <array_list.h>
+#include <epoch.h>
+#include <traits.h>
+
+namespace structures {
+
+/**
+ * @brief A thread-safe AVL tree with lock-free lookups
+ *
+ * @details This is the optimistic relaxed balance AVL tree of Bronson et al.
+ * ("A Practical Concurrent Binary Search Tree"). Readers never lock: they
+ * descend the tree hand-over-hand, remembering the version of each node and
+ * checking it again after reading the next one, and retry from the parent
+ * when a rotation changed the subtree under them. Writers only lock the
+ * few nodes that they change, always from parents to children, so
+ * operations on different parts of the tree do not wait for each other.
+ *
+ * Removing an element with two children just marks its node as a routing
+ * node, which is unlinked later when it has at most one child. Unlinked
+ * nodes are reclaimed through the epoch domain, as readers may still be
+ * passing through them.
+ *
+ * insert, remove and contains may be called concurrently by any amount of
+ * threads. The other methods (copies, clear, items) must not run
+ * concurrently with writers.
+ *
+ * @tparam T Data type of the elements
+ */
+template <typename T>
+class ConcurrentAVLTree {
+	struct Node;
+
+public:
+	ConcurrentAVLTree() = default;
+
+	ConcurrentAVLTree(const ConcurrentAVLTree<T>& other) {
+		auto list = other.items();
+		for (std::size_t i = 0; i < list.size(); i++)
+			insert(list[i]);
+	}
+
+	ConcurrentAVLTree(ConcurrentAVLTree<T>&& other)
+		: holder{other.holder}, size_{other.size_.load()} {
+		other.holder = new Node{T{}, nullptr};
+		other.size_ = 0;
+	}
+
+	ConcurrentAVLTree<T>& operator=(const ConcurrentAVLTree<T>& other) {
+		ConcurrentAVLTree<T> copy{other};
+		swap(copy);
+		return *this;
+	}
+
+	ConcurrentAVLTree<T>& operator=(ConcurrentAVLTree<T>&& other) {
+		ConcurrentAVLTree<T> copy{std::move(other)};
+		swap(copy);
+		return *this;
+	}
+
+	~ConcurrentAVLTree() {
+		destroy(holder->right);
+		delete holder;
+	}
+
+	/**
+	 * @brief Inserts `data` into the tree
+	 *
+	 * @return false if `data` was already in the tree, otherwise true
+	 */
+	bool insert(const T& data) { return update(data, true); }
+
+	/**
+	 * @brief Removes `data` from the tree
+	 *
+	 * @return false if `data` was not in the tree, otherwise true
+	 */
+	bool remove(const T& data) { return update(data, false); }
+
+	/**
+	 * @brief Returns true if the tree contains `data`, without locking
+	 */
+	bool contains(const T& data) const {
+		epoch::Guard guard;
+		while (true) {
+			Node* right = holder->right;
+			if (right == nullptr)
+				return false;
+			if (equal(data, right->key))
+				return right->present;
+
+			std::uint64_t version = right->version;
+			if (changing(version)) {
+				wait_until_not_changing(right);
+			} else if (right == holder->right) {
+				Result r = attempt_get(data, right, direction(data, right),
+									   version);
+				if (r != Retry)
+					return r == True;
+			}
+		}
+	}
+
+	/**
+	 * @brief Removes all the elements, must not run concurrently
+	 */
+	void clear() {
+		destroy(holder->right);
+		holder->right = nullptr;
+		holder->height = 1;
+		size_ = 0;
+	}
+
+	std::size_t size() const { return size_; }
+
+	/**
+	 * @brief Returns the elements of the tree, in order
+	 */
+	ArrayList<T> items() const {
+		epoch::Guard guard;
+		ArrayList<T> out{size_ + 1};
+		in_order(holder->right, out);
+		return out;
+	}
+
+private:
+	enum Result { False, True, Retry };
+
+	// version bits: unlinked, changing (being rotated down) and a counter
+	const static std::uint64_t unlinked{1};
+	const static std::uint64_t changing_bit{2};
+	const static std::uint64_t change_increment{4};
+
+	// special values returned by node_condition
+	const static int unlink_required{-1};
+	const static int rebalance_required{-2};
+	const static int nothing_required{-3};
+
+	struct Node {
+		Node(const T& key_, Node* parent_) : key{key_}, parent{parent_} {}
+
+		const T key;
+		std::atomic<bool> present{true};
+		std::atomic<int> height{1};
+		std::atomic<std::uint64_t> version{0};
+		std::atomic<Node*> parent;
+		std::atomic<Node*> left{nullptr};
+		std::atomic<Node*> right{nullptr};
+		std::mutex lock;
+
+		std::atomic<Node*>& child(int dir) { return dir < 0 ? left : right; }
+	};
+
+	using Lock = std::lock_guard<std::mutex>;
+
+	static bool equal(const T& a, const T& b) { return !(a < b || b < a); }
+
+	// -1 if `data` belongs to the left of `node`, 1 otherwise
+	static int direction(const T& data, const Node* node) {
+		return data < node->key ? -1 : 1;
+	}
+
+	static bool changing(std::uint64_t v) {
+		return (v & (unlinked | changing_bit)) != 0;
+	}
+
+	static std::uint64_t begin_change(std::uint64_t v) {
+		return v | changing_bit;
+	}
+
+	static std::uint64_t end_change(std::uint64_t v) {
+		return (v & ~(changing_bit | unlinked)) + change_increment;
+	}
+
+	static bool is_unlinked(const Node* n) {
+		return (n->version & unlinked) != 0;
+	}
+
+	static int height(const Node* n) { return n ? n->height.load() : 0; }
+
+	// rotations hold the lock of the node that is changing
+	static void wait_until_not_changing(Node* n) {
+		if ((n->version & changing_bit) != 0) {
+			Lock lock{n->lock};
+		}
+	}
+
+	Result attempt_get(
+		const T& data, Node* node, int dir, std::uint64_t version) const {
+		while (true) {
+			Node* child = node->child(dir);
+			if (node->version != version)
+				return Retry;
+			if (child == nullptr)
+				return False;
+			if (equal(data, child->key))
+				return child->present ? True : False;
+
+			std::uint64_t child_version = child->version;
+			if (changing(child_version)) {
+				wait_until_not_changing(child);
+			} else if (child == node->child(dir)) {
+				if (node->version != version)
+					return Retry;
+				Result r = attempt_get(
+					data, child, direction(data, child), child_version);
+				if (r != Retry)
+					return r;
+			}
+		}
+	}
+
+	bool update(const T& data, bool insert) {
+		epoch::Guard guard;
+		while (true) {
+			Node* right = holder->right;
+			if (right == nullptr) {
+				if (!insert)
+					return false;
+				Lock lock{holder->lock};
+				if (holder->right == nullptr) {
+					holder->right = new Node{data, holder};
+					++size_;
+					return true;
+				}
+			} else {
+				std::uint64_t version = right->version;
+				if (changing(version)) {
+					wait_until_not_changing(right);
+				} else if (right == holder->right) {
+					Result r = attempt_update(
+						data, insert, holder, right, version);
+					if (r == True && insert)
+						++size_;
+					else if (r == True)
+						--size_;
+					if (r != Retry)
+						return r == True;
+				}
+			}
+		}
+	}
+
+	Result attempt_update(
+		const T& data, bool insert, Node* parent, Node* node,
+		std::uint64_t version) {
+		if (equal(data, node->key))
+			return attempt_node_update(insert, parent, node);
+
+		int dir = direction(data, node);
+		while (true) {
+			Node* child = node->child(dir);
+			if (node->version != version)
+				return Retry;
+
+			if (child == nullptr) {
+				if (!insert)
+					return False;
+
+				Node* damaged;
+				{
+					Lock lock{node->lock};
+					if (node->version != version)
+						return Retry;
+					if (node->child(dir) != nullptr)
+						continue;  // someone else inserted there, retry
+					node->child(dir) = new Node{data, node};
+					damaged = fix_height(node);
+				}
+				fix_height_and_rebalance(damaged);
+				return True;
+			}
+
+			std::uint64_t child_version = child->version;
+			if (changing(child_version)) {
+				wait_until_not_changing(child);
+			} else if (child == node->child(dir)) {
+				if (node->version != version)
+					return Retry;
+				Result r =
+					attempt_update(data, insert, node, child, child_version);
+				if (r != Retry)
+					return r;
+			}
+		}
+	}
+
+	Result attempt_node_update(bool insert, Node* parent, Node* node) {
+		if (!insert && !node->present)
+			return False;
+
+		if (!insert && (node->left == nullptr || node->right == nullptr)) {
+			// the node may be unlinked, which also changes its parent
+			Node* damaged;
+			{
+				Lock parent_lock{parent->lock};
+				if (is_unlinked(parent) || node->parent != parent)
+					return Retry;
+
+				Lock lock{node->lock};
+				if (!node->present)
+					return False;
+				if (node->left && node->right) {
+					node->present = false;  // it became a routing node
+					return True;
+				}
+				if (!attempt_unlink(parent, node))
+					return Retry;
+				damaged = fix_height(parent);
+			}
+			fix_height_and_rebalance(damaged);
+			return True;
+		}
+
+		{
+			Lock lock{node->lock};
+			if (is_unlinked(node))
+				return Retry;
+			if (node->present == insert)
+				return False;
+			node->present = insert;
+		}
+		// a routing node may have lost a child in the meantime
+		if (!insert)
+			fix_height_and_rebalance(node);
+		return True;
+	}
+
+	// removes `node`, which has at most one child, from the tree
+	static bool attempt_unlink(Node* parent, Node* node) {
+		Node* parent_left = parent->left;
+		Node* parent_right = parent->right;
+		if (parent_left != node && parent_right != node)
+			return false;
+
+		Node* left = node->left;
+		Node* right = node->right;
+		if (left && right)
+			return false;
+
+		Node* splice = left ? left : right;
+		if (parent_left == node)
+			parent->left = splice;
+		else
+			parent->right = splice;
+		if (splice)
+			splice->parent = parent;
+
+		node->version = unlinked;
+		node->present = false;
+		epoch::retire(node);
+		return true;
+	}
+
+	/*
+	 * Returns unlink_required, rebalance_required, nothing_required, or the
+	 * height that `node` should have.
+	 */
+	static int node_condition(Node* node) {
+		Node* left = node->left;
+		Node* right = node->right;
+		if ((left == nullptr || right == nullptr) && !node->present)
+			return unlink_required;
+
+		int h = node->height;
+		int hl = height(left);
+		int hr = height(right);
+		int new_h = 1 + std::max(hl, hr);
+		int balance = hl - hr;
+		if (balance < -1 || balance > 1)
+			return rebalance_required;
+		return h != new_h ? new_h : nothing_required;
+	}
+
+	void fix_height_and_rebalance(Node* node) {
+		while (node && node->parent) {
+			int condition = node_condition(node);
+			if (condition == nothing_required || is_unlinked(node))
+				return;
+
+			if (condition != unlink_required &&
+				condition != rebalance_required) {
+				Lock lock{node->lock};
+				node = fix_height(node);
+			} else {
+				Node* parent = node->parent;
+				Lock parent_lock{parent->lock};
+				if (!is_unlinked(parent) && node->parent == parent) {
+					Lock lock{node->lock};
+					node = rebalance(parent, node);
+				}
+			}
+		}
+	}
+
+	// requires the lock of `node`, returns the next node to fix
+	static Node* fix_height(Node* node) {
+		int condition = node_condition(node);
+		switch (condition) {
+		case rebalance_required:
+		case unlink_required:
+			return node;
+		case nothing_required:
+			return nullptr;
+		default:
+			node->height = condition;
+			return node->parent;
+		}
+	}
+
+	// requires the locks of `parent` and `n`
+	Node* rebalance(Node* parent, Node* n) {
+		Node* left = n->left;
+		Node* right = n->right;
+
+		if ((left == nullptr || right == nullptr) && !n->present) {
+			if (attempt_unlink(parent, n))
+				return fix_height(parent);
+			return n;
+		}
+
+		int h = n->height;
+		int hl = height(left);
+		int hr = height(right);
+		int new_h = 1 + std::max(hl, hr);
+		int balance = hl - hr;
+
+		if (balance > 1)
+			return rebalance_to_right(parent, n, left, hr);
+		if (balance < -1)
+			return rebalance_to_left(parent, n, right, hl);
+		if (new_h != h) {
+			n->height = new_h;
+			return fix_height(parent);
+		}
+		return nullptr;
+	}
+
+	Node* rebalance_to_right(Node* parent, Node* n, Node* nl, int hr) {
+		Lock lock{nl->lock};
+		int hl = nl->height;
+		if (hl - hr <= 1)
+			return n;  // retry
+
+		Node* nlr = nl->right;
+		int hll = height(nl->left);
+		int hlr = height(nlr);
+		if (hll >= hlr)
+			return rotate_right(parent, n, nl, hr, hll, nlr, hlr);
+
+		{
+			Lock lr_lock{nlr->lock};
+			hlr = nlr->height;
+			if (hll >= hlr)
+				return rotate_right(parent, n, nl, hr, hll, nlr, hlr);
+
+			int hlrl = height(nlr->left);
+			int b = hll - hlrl;
+			if (b >= -1 && b <= 1 &&
+				!((hll == 0 || hlrl == 0) && !nl->present))
+				return rotate_right_over_left(
+					parent, n, nl, hr, hll, nlr, hlrl);
+		}
+		// the left child needs to be rotated first
+		return rebalance_to_left(n, nl, nlr, hll);
+	}
+
+	Node* rebalance_to_left(Node* parent, Node* n, Node* nr, int hl) {
+		Lock lock{nr->lock};
+		int hr = nr->height;
+		if (hl - hr >= -1)
+			return n;  // retry
+
+		Node* nrl = nr->left;
+		int hrl = height(nrl);
+		int hrr = height(nr->right);
+		if (hrr >= hrl)
+			return rotate_left(parent, n, hl, nr, nrl, hrl, hrr);
+
+		{
+			Lock rl_lock{nrl->lock};
+			hrl = nrl->height;
+			if (hrr >= hrl)
+				return rotate_left(parent, n, hl, nr, nrl, hrl, hrr);
+
+			int hrlr = height(nrl->right);
+			int b = hrr - hrlr;
+			if (b >= -1 && b <= 1 &&
+				!((hrr == 0 || hrlr == 0) && !nr->present))
+				return rotate_left_over_right(
+					parent, n, hl, nr, nrl, hrr, hrlr);
+		}
+		return rebalance_to_right(n, nr, nrl, hrr);
+	}
+
+	static void replace_child(Node* parent, Node* old_child, Node* new_child) {
+		if (parent->left == old_child)
+			parent->left = new_child;
+		else
+			parent->right = new_child;
+		new_child->parent = parent;
+	}
+
+	/* Rotations, the node `n` is the one that moves down:
+	 *
+	 *       n       right      nl
+	 *      / \     ----->     /  \
+	 *     nl  r             ll    n
+	 *    / \                     / \
+	 *   ll  nlr                nlr  r
+	 */
+	Node* rotate_right(
+		Node* parent, Node* n, Node* nl, int hr, int hll, Node* nlr,
+		int hlr) {
+		std::uint64_t version = n->version;
+		n->version = begin_change(version);
+
+		n->left = nlr;
+		if (nlr)
+			nlr->parent = n;
+		nl->right = n;
+		n->parent = nl;
+		replace_child(parent, n, nl);
+
+		int hn = 1 + std::max(hlr, hr);
+		n->height = hn;
+		nl->height = 1 + std::max(hll, hn);
+
+		n->version = end_change(version);
+
+		int bal_n = hlr - hr;
+		if (bal_n < -1 || bal_n > 1)
+			return n;
+		if ((nlr == nullptr || hr == 0) && !n->present)
+			return n;
+		int bal_l = hll - hn;
+		if (bal_l < -1 || bal_l > 1)
+			return nl;
+		if (hll == 0 && !nl->present)
+			return nl;
+		return fix_height(parent);
+	}
+
+	Node* rotate_left(
+		Node* parent, Node* n, int hl, Node* nr, Node* nrl, int hrl,
+		int hrr) {
+		std::uint64_t version = n->version;
+		n->version = begin_change(version);
+
+		n->right = nrl;
+		if (nrl)
+			nrl->parent = n;
+		nr->left = n;
+		n->parent = nr;
+		replace_child(parent, n, nr);
+
+		int hn = 1 + std::max(hl, hrl);
+		n->height = hn;
+		nr->height = 1 + std::max(hn, hrr);
+
+		n->version = end_change(version);
+
+		int bal_n = hrl - hl;
+		if (bal_n < -1 || bal_n > 1)
+			return n;
+		if ((nrl == nullptr || hl == 0) && !n->present)
+			return n;
+		int bal_r = hrr - hn;
+		if (bal_r < -1 || bal_r > 1)
+			return nr;
+		if (hrr == 0 && !nr->present)
+			return nr;
+		return fix_height(parent);
+	}
+
+	Node* rotate_right_over_left(
+		Node* parent, Node* n, Node* nl, int hr, int hll, Node* nlr,
+		int hlrl) {
+		std::uint64_t version = n->version;
+		std::uint64_t left_version = nl->version;
+		Node* nlrl = nlr->left;
+		Node* nlrr = nlr->right;
+		int hlrr = height(nlrr);
+
+		n->version = begin_change(version);
+		nl->version = begin_change(left_version);
+
+		n->left = nlrr;
+		if (nlrr)
+			nlrr->parent = n;
+		nl->right = nlrl;
+		if (nlrl)
+			nlrl->parent = nl;
+		nlr->left = nl;
+		nl->parent = nlr;
+		nlr->right = n;
+		n->parent = nlr;
+		replace_child(parent, n, nlr);
+
+		int hn = 1 + std::max(hlrr, hr);
+		n->height = hn;
+		int hl = 1 + std::max(hll, hlrl);
+		nl->height = hl;
+		nlr->height = 1 + std::max(hl, hn);
+
+		n->version = end_change(version);
+		nl->version = end_change(left_version);
+
+		int bal_n = hlrr - hr;
+		if (bal_n < -1 || bal_n > 1)
+			return n;
+		if ((nlrr == nullptr || hr == 0) && !n->present)
+			return n;
+		int bal_lr = hl - hn;
+		if (bal_lr < -1 || bal_lr > 1)
+			return nlr;
+		return fix_height(parent);
+	}
+
+	Node* rotate_left_over_right(
+		Node* parent, Node* n, int hl, Node* nr, Node* nrl, int hrr,
+		int hrlr) {
+		std::uint64_t version = n->version;
+		std::uint64_t right_version = nr->version;
+		Node* nrll = nrl->left;
+		Node* nrlr = nrl->right;
+		int hrll = height(nrll);
+
+		n->version = begin_change(version);
+		nr->version = begin_change(right_version);
+
+		n->right = nrll;
+		if (nrll)
+			nrll->parent = n;
+		nr->left = nrlr;
+		if (nrlr)
+			nrlr->parent = nr;
+		nrl->right = nr;
+		nr->parent = nrl;
+		nrl->left = n;
+		n->parent = nrl;
+		replace_child(parent, n, nrl);
+
+		int hn = 1 + std::max(hl, hrll);
+		n->height = hn;
+		int hr = 1 + std::max(hrlr, hrr);
+		nr->height = hr;
+		nrl->height = 1 + std::max(hn, hr);
+
+		n->version = end_change(version);
+		nr->version = end_change(right_version);
+
+		int bal_n = hrll - hl;
+		if (bal_n < -1 || bal_n > 1)
+			return n;
+		if ((nrll == nullptr || hl == 0) && !n->present)
+			return n;
+		int bal_rl = hr - hn;
+		if (bal_rl < -1 || bal_rl > 1)
+			return nrl;
+		return fix_height(parent);
+	}
+
+	static void in_order(const Node* n, ArrayList<T>& out) {
+		if (n == nullptr)
+			return;
+		in_order(n->left, out);
+		if (n->present)
+			out.push_back(n->key);
+		in_order(n->right, out);
+	}
+
+	static void destroy(Node* n) {
+		if (n == nullptr)
+			return;
+		destroy(n->left);
+		destroy(n->right);
+		delete n;
+	}
+
+	void swap(ConcurrentAVLTree<T>& other) {
+		std::swap(holder, other.holder);
+		std::size_t size = size_;
+		size_ = other.size_.load();
+		other.size_ = size;
+	}
+
+	// the root of the tree is the right child of this node
+	Node* holder{new Node{T{}, nullptr}};
+	std::atomic<std::size_t> size_{0u};
+};
+
+}  // namespace structures
+
+/* set trait */
+template <>
+const bool traits::is_set<structures::ConcurrentAVLTree>::value = true;
+
+/* name trait */
+template <>
+const std::string traits::type<structures::ConcurrentAVLTree>::name =
+	"ConcurrentAVLTree";
+
+#endif
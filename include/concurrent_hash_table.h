@@ -0,0 +1,360 @@
+#ifndef STRUCTURES_CONCURRENT_HASH_TABLE_H
+#define STRUCTURES_CONCURRENT_HASH_TABLE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+#include <array_list.h>
+#include <epoch.h>
+#include <traits.h>
+#include <utils.h>
+
+namespace structures {
+
+/**
+ * @brief A thread-safe HashTable with lock-free lookups
+ *
+ * @details Buckets are linked lists whose heads are published atomically.
+ * Writers lock one of 64 stripes, chosen by the bucket, so writers of
+ * different stripes never wait for each other. Readers do not lock at all:
+ * they follow the links, and removed nodes are reclaimed through the epoch
+ * domain since readers may still be passing through them.
+ *
+ * When a stripe gets more elements than buckets, the table doubles. Every
+ * writer that finds a resize going on helps it: it claims a range of old
+ * buckets, copies each of them into the new array while holding its stripe
+ * (a bucket `i` splits into `i` and `i + size`, which are in the same
+ * stripe), and then replaces the old head with a forwarding marker that
+ * sends readers and writers to the new array. Nodes are copied rather than
+ * relinked, so readers inside an old bucket still see all its elements. The
+ * table does not shrink.
+ *
+ * insert, remove, contains and size may be called concurrently by any
+ * amount of threads. The other methods (copies, clear, items) must not run
+ * concurrently with writers.
+ *
+ * @tparam T    Data type of the elements
+ * @tparam Hash Class that implements the hash function
+ */
+template <typename T, typename Hash = std::hash<T>>
+class ConcurrentHashTableWrapper {
+	struct Table;
+
+public:
+	ConcurrentHashTableWrapper() = default;
+
+	ConcurrentHashTableWrapper(
+		const ConcurrentHashTableWrapper<T, Hash>& other) {
+		auto list = other.items();
+		for (std::size_t i = 0; i < list.size(); i++)
+			insert(list[i]);
+	}
+
+	ConcurrentHashTableWrapper(ConcurrentHashTableWrapper<T, Hash>&& other)
+		: table{other.table.exchange(new Table{starting_size})} {
+		for (std::size_t i = 0; i < stripes; i++)
+			counts[i].value = other.counts[i].value.exchange(0);
+	}
+
+	ConcurrentHashTableWrapper<T, Hash>& operator=(
+		const ConcurrentHashTableWrapper<T, Hash>& other) {
+		ConcurrentHashTableWrapper<T, Hash> copy{other};
+		swap(copy);
+		return *this;
+	}
+
+	ConcurrentHashTableWrapper<T, Hash>& operator=(
+		ConcurrentHashTableWrapper<T, Hash>&& other) {
+		ConcurrentHashTableWrapper<T, Hash> copy{std::move(other)};
+		swap(copy);
+		return *this;
+	}
+
+	~ConcurrentHashTableWrapper() { destroy(table); }
+
+	/**
+	 * @brief Inserts `data` into the table
+	 *
+	 * @return false if `data` was already in the table, otherwise true
+	 */
+	bool insert(const T& data) {
+		epoch::Guard guard;
+		std::uint64_t h = hash(data);
+		Table* t = writable_table();
+		while (true) {
+			std::size_t i = h & (t->size - 1);
+			std::unique_lock<std::mutex> lock{locks[i % stripes].mutex};
+			Link* head = t->buckets[i].load(std::memory_order_relaxed);
+			if (head == forwarded()) {
+				lock.unlock();
+				t = help_resize(t);
+				continue;
+			}
+
+			for (Link* l = head; l; l = l->next.load(std::memory_order_relaxed))
+				if (static_cast<Node*>(l)->data == data)
+					return false;
+
+			Node* node = new Node{data};
+			node->next.store(head, std::memory_order_relaxed);
+			t->buckets[i].store(node, std::memory_order_release);
+			std::size_t count = ++counts[i % stripes].value;
+			lock.unlock();
+
+			if (count > t->size / stripes)
+				start_resize(t);
+			return true;
+		}
+	}
+
+	/**
+	 * @brief Removes `data` from the table
+	 *
+	 * @return false if `data` was not in the table, otherwise true
+	 */
+	bool remove(const T& data) {
+		epoch::Guard guard;
+		std::uint64_t h = hash(data);
+		Table* t = writable_table();
+		while (true) {
+			std::size_t i = h & (t->size - 1);
+			std::unique_lock<std::mutex> lock{locks[i % stripes].mutex};
+			Link* head = t->buckets[i].load(std::memory_order_relaxed);
+			if (head == forwarded()) {
+				lock.unlock();
+				t = help_resize(t);
+				continue;
+			}
+
+			std::atomic<Link*>* previous = &t->buckets[i];
+			for (Link* l = head; l; l = l->next.load(std::memory_order_relaxed)) {
+				Node* node = static_cast<Node*>(l);
+				if (node->data == data) {
+					// readers inside `node` still reach the rest of the list
+					previous->store(
+						node->next.load(std::memory_order_relaxed),
+						std::memory_order_release);
+					--counts[i % stripes].value;
+					lock.unlock();
+					epoch::retire(node);
+					return true;
+				}
+				previous = &node->next;
+			}
+			return false;
+		}
+	}
+
+	/**
+	 * @brief Returns true if the element is in the table, without locking
+	 */
+	bool contains(const T& data) const {
+		epoch::Guard guard;
+		std::uint64_t h = hash(data);
+		Table* t = table.load(std::memory_order_acquire);
+		while (true) {
+			Link* l = t->buckets[h & (t->size - 1)].load(
+				std::memory_order_acquire);
+			if (l == forwarded()) {
+				t = t->next.load(std::memory_order_acquire);
+				continue;
+			}
+			for (; l; l = l->next.load(std::memory_order_acquire))
+				if (static_cast<Node*>(l)->data == data)
+					return true;
+			return false;
+		}
+	}
+
+	/**
+	 * @brief Removes all the elements, must not run concurrently
+	 */
+	void clear() {
+		destroy(table.exchange(new Table{starting_size}));
+		for (std::size_t i = 0; i < stripes; i++)
+			counts[i].value = 0;
+	}
+
+	std::size_t size() const {
+		std::size_t total = 0;
+		for (std::size_t i = 0; i < stripes; i++)
+			total += counts[i].value.load(std::memory_order_relaxed);
+		return total;
+	}
+
+	/**
+	 * @brief Returns a list of the items that are on the table
+	 */
+	ArrayList<T> items() const {
+		epoch::Guard guard;
+		ArrayList<T> al{size() + 1};
+		Table* t = table;
+		for (std::size_t i = 0; i < t->size; i++)
+			for (Link* l = t->buckets[i]; l; l = l->next)
+				al.push_back(static_cast<Node*>(l)->data);
+		return al;
+	}
+
+private:
+	struct Link {
+		std::atomic<Link*> next{nullptr};
+	};
+
+	struct Node : Link {
+		explicit Node(const T& data_) : data{data_} {}
+
+		const T data;
+	};
+
+	struct Table {
+		explicit Table(std::size_t size_)
+			: buckets{new std::atomic<Link*>[size_]}, size{size_} {
+			for (std::size_t i = 0; i < size; i++)
+				buckets[i].store(nullptr, std::memory_order_relaxed);
+		}
+
+		std::unique_ptr<std::atomic<Link*>[]> buckets;
+		const std::size_t size;
+
+		// set when a resize starts, the table that replaces this one
+		std::atomic<Table*> next{nullptr};
+		// buckets claimed by and copied by the threads resizing
+		std::atomic<std::size_t> claimed{0u};
+		std::atomic<std::size_t> copied{0u};
+	};
+
+	struct alignas(64) Stripe {
+		std::mutex mutex;
+	};
+
+	struct alignas(64) Count {
+		std::atomic<std::size_t> value{0u};
+	};
+
+	const static std::size_t stripes{64};
+	const static std::size_t starting_size{stripes};
+	const static std::size_t resize_chunk{64};
+
+	// the head of an old bucket that was already copied to the next table
+	static Link* forwarded() {
+		static Link link;
+		return &link;
+	}
+
+	std::uint64_t hash(const T& data) const {
+		return spread_hash<Hash>(hashf(data));
+	}
+
+	// the current table, after helping the resize that is going on, if any
+	Table* writable_table() {
+		Table* t = table.load(std::memory_order_acquire);
+		if (t->next.load(std::memory_order_acquire))
+			help_resize(t);
+		return t;
+	}
+
+	void start_resize(Table* t) {
+		if (table.load() != t || t->next.load())
+			return;
+		Table* expected = nullptr;
+		Table* next = new Table{2 * t->size};
+		if (t->next.compare_exchange_strong(expected, next))
+			help_resize(t);
+		else
+			delete next;
+	}
+
+	/*
+	 * Copies chunks of buckets of `t` until none is left, publishes the next
+	 * table when all were copied, and returns it.
+	 */
+	Table* help_resize(Table* t) {
+		Table* next = t->next.load(std::memory_order_acquire);
+		while (true) {
+			std::size_t first = t->claimed.fetch_add(resize_chunk);
+			if (first >= t->size)
+				return next;
+
+			std::size_t last = std::min(first + resize_chunk, t->size);
+			for (std::size_t i = first; i < last; i++)
+				copy_bucket(t, next, i);
+
+			if (t->copied.fetch_add(last - first) + last - first == t->size) {
+				table.store(next, std::memory_order_release);
+				epoch::retire(t);
+			}
+		}
+	}
+
+	void copy_bucket(Table* t, Table* next, std::size_t i) {
+		std::lock_guard<std::mutex> lock{locks[i % stripes].mutex};
+		Link* head = t->buckets[i].load(std::memory_order_relaxed);
+		for (Link* l = head; l; l = l->next.load(std::memory_order_relaxed)) {
+			const T& data = static_cast<Node*>(l)->data;
+			auto& bucket = next->buckets[hash(data) & (next->size - 1)];
+			Node* copy = new Node{data};
+			copy->next.store(
+				bucket.load(std::memory_order_relaxed),
+				std::memory_order_relaxed);
+			bucket.store(copy, std::memory_order_relaxed);
+		}
+		t->buckets[i].store(forwarded(), std::memory_order_release);
+
+		while (head) {
+			Link* next_link = head->next.load(std::memory_order_relaxed);
+			epoch::retire(static_cast<Node*>(head));
+			head = next_link;
+		}
+	}
+
+	static void destroy(Table* t) {
+		for (std::size_t i = 0; i < t->size; i++) {
+			Link* l = t->buckets[i];
+			if (l == forwarded())
+				continue;
+			while (l) {
+				Link* next = l->next;
+				delete static_cast<Node*>(l);
+				l = next;
+			}
+		}
+		delete t;
+	}
+
+	void swap(ConcurrentHashTableWrapper<T, Hash>& other) {
+		Table* t = table;
+		table = other.table.load();
+		other.table = t;
+		for (std::size_t i = 0; i < stripes; i++) {
+			std::size_t count = counts[i].value;
+			counts[i].value = other.counts[i].value.load();
+			other.counts[i].value = count;
+		}
+	}
+
+	std::atomic<Table*> table{new Table{starting_size}};
+	Stripe locks[stripes];
+	Count counts[stripes];
+
+	Hash hashf{};
+};
+
+template <typename T>
+class ConcurrentHashTable : public ConcurrentHashTableWrapper<T> {};
+
+}  // namespace structures
+
+/* set trait */
+template <>
+const bool traits::is_set<structures::ConcurrentHashTable>::value = true;
+
+/* name trait */
+template <>
+const std::string traits::type<structures::ConcurrentHashTable>::name =
+	"ConcurrentHashTable";
+
+#endif
@@ -0,0 +1,181 @@
+#ifndef STRUCTURES_CONCURRENT_PRIORITY_QUEUE_H
+#define STRUCTURES_CONCURRENT_PRIORITY_QUEUE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include <heap.h>
+#include <traits.h>
+#include <utils.h>
+
+namespace structures {
+
+/**
+ * @brief A thread-safe, relaxed priority queue (MultiQueue)
+ *
+ * @details The elements are spread over several Heaps, each behind its own
+ * lock, with more heaps than threads so that threads rarely meet. push adds
+ * to a random heap. try_pop picks two random heaps and removes the larger of
+ * their tops. If a lock is taken it picks again, so threads do not wait for
+ * each other. Only when the picks keep failing does try_pop look at every
+ * heap in turn, waiting for each lock, so that it only returns false when
+ * the queue is empty.
+ *
+ * The result is that try_pop does not always return the largest element,
+ * but one close to it: the expected rank of the popped element grows with
+ * the amount of heaps, not with the amount of elements. The amount of heaps
+ * is the relaxation factor times the amount of threads. A larger factor
+ * means less contention and a worse order.
+ *
+ * push, try_pop and size may be called concurrently by any amount of
+ * threads. The queue is not copyable.
+ *
+ * @tparam          T Data type of the elements
+ * @tparam Comparator Type providing a strict weak ordering function
+ */
+template <typename T, typename Comparator = std::less<T>>
+class ConcurrentPriorityQueueWrapper {
+public:
+	/**
+	 * @brief Creates `factor * threads` heaps, and at least two
+	 */
+	explicit ConcurrentPriorityQueueWrapper(
+		std::size_t threads = std::thread::hardware_concurrency(),
+		std::size_t factor = 2)
+		: queues_size{std::max<std::size_t>(2, factor * threads)}
+		, queues{new Queue[queues_size]} {}
+
+	ConcurrentPriorityQueueWrapper(
+		const ConcurrentPriorityQueueWrapper<T, Comparator>&) = delete;
+
+	ConcurrentPriorityQueueWrapper<T, Comparator>& operator=(
+		const ConcurrentPriorityQueueWrapper<T, Comparator>&) = delete;
+
+	/**
+	 * @brief Inserts an element into the queue
+	 */
+	void push(const T& data) { push(T(data)); }
+
+	void push(T&& data) {
+		// counted before it can be popped, so that the size never wraps
+		size_.fetch_add(1, std::memory_order_relaxed);
+		while (true) {
+			Queue& q = queues[random_index()];
+			std::unique_lock<std::mutex> lock{q.mutex, std::try_to_lock};
+			if (lock.owns_lock()) {
+				q.heap.push(std::move(data));
+				q.size.store(q.heap.size(), std::memory_order_relaxed);
+				break;
+			}
+		}
+	}
+
+	/**
+	 * @brief Removes one of the larger elements of the queue into `out`
+	 *
+	 * @return false if the queue was empty, otherwise true
+	 */
+	bool try_pop(T& out) {
+		for (std::size_t attempt = 0; attempt < queues_size; attempt++) {
+			if (size_.load(std::memory_order_relaxed) == 0)
+				return false;
+			Queue& a = queues[random_index()];
+			Queue& b = queues[random_index()];
+			if (&a == &b || (a.empty() && b.empty()))
+				continue;
+
+			std::unique_lock<std::mutex> lock_a{a.mutex, std::try_to_lock};
+			if (!lock_a.owns_lock())
+				continue;
+			std::unique_lock<std::mutex> lock_b{b.mutex, std::try_to_lock};
+			if (!lock_b.owns_lock())
+				continue;
+
+			if (b.heap.size() > 0 &&
+				(a.heap.size() == 0 || comp(a.heap.top(), b.heap.top()))) {
+				take(b, out);
+				return true;
+			}
+			if (a.heap.size() > 0) {
+				take(a, out);
+				return true;
+			}
+		}
+
+		// the sampled heaps kept being empty or locked, so look at all of
+		// them, which only finds nothing if the queue is empty
+		for (std::size_t i = 0; i < queues_size; i++) {
+			std::lock_guard<std::mutex> lock{queues[i].mutex};
+			if (queues[i].heap.size() > 0) {
+				take(queues[i], out);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/**
+	 * @brief Amount of heaps the elements are spread over
+	 */
+	std::size_t queues_count() const { return queues_size; }
+
+	/**
+	 * @brief Amount of elements, counting the ones being pushed
+	 */
+	std::size_t size() const { return size_.load(std::memory_order_relaxed); }
+
+private:
+	struct alignas(64) Queue {
+		std::mutex mutex;
+		HeapWrapper<T, Comparator> heap;
+		// the size of the heap, readable without the lock
+		std::atomic<std::size_t> size{0u};
+
+		bool empty() const {
+			return size.load(std::memory_order_relaxed) == 0;
+		}
+	};
+
+	// pops the top of `q`, which must be locked and not empty
+	void take(Queue& q, T& out) {
+		out = q.heap.pop();
+		q.size.store(q.heap.size(), std::memory_order_relaxed);
+		size_.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	std::size_t random_index() const {
+		// xorshift, seeded differently by every thread
+		static thread_local std::uint64_t state = mix_hash(
+			std::hash<std::thread::id>{}(std::this_thread::get_id())) | 1;
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+		return state % queues_size;
+	}
+
+	std::size_t queues_size;
+	std::unique_ptr<Queue[]> queues;
+	std::atomic<std::size_t> size_{0u};
+	Comparator comp;
+};
+
+template <typename T>
+class ConcurrentPriorityQueue : public ConcurrentPriorityQueueWrapper<T> {
+public:
+	using ConcurrentPriorityQueueWrapper<T>::ConcurrentPriorityQueueWrapper;
+};
+
+}  // namespace structures
+
+/* name trait */
+template <>
+const std::string traits::type<structures::ConcurrentPriorityQueue>::name =
+	"ConcurrentPriorityQueue";
+
+#endif
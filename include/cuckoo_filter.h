@@ -0,0 +1,246 @@
+#ifndef STRUCTURES_CUCKOO_FILTER_H
+#define STRUCTURES_CUCKOO_FILTER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#include <utils.h>
+
+namespace structures {
+
+/**
+ * @brief Cuckoo filter
+ *
+ * @details A probabilistic set that, unlike a Bloom filter, supports removal.
+ * It stores a 16 bit fingerprint of each element in one of two buckets of 4
+ * fingerprints. The second bucket is computed from the first one and the
+ * fingerprint alone, so a fingerprint can be moved to its other bucket
+ * without knowing its element: when both buckets are full, a fingerprint is
+ * evicted to its other bucket, which may evict another, and so on.
+ *
+ * An element may only be removed if it was inserted, and it must not be
+ * inserted twice without being removed in between, otherwise other elements
+ * may be lost. About 0.01% of the lookups of absent elements are false
+ * positives, and the filter fills up at about 95% of its slots.
+ *
+ * @tparam T    Data type of the elements
+ * @tparam Hash Class that implements the hash function
+ */
+template <typename T, typename Hash = std::hash<T>>
+class CuckooFilter {
+public:
+	/**
+	 * @brief Creates a filter sized for `capacity` elements
+	 */
+	explicit CuckooFilter(std::size_t capacity = 0) {
+		std::size_t needed = capacity * 100 / 95 / slots + 1;
+		while (buckets < needed)
+			buckets *= 2;
+		data.reset(new Bucket[buckets]);
+		clear();
+	}
+
+	CuckooFilter(const CuckooFilter<T, Hash>& other)
+		: buckets{other.buckets}
+		, size_{other.size_}
+		, victim{other.victim}
+		, data{new Bucket[buckets]} {
+		std::copy(other.data.get(), other.data.get() + buckets, data.get());
+	}
+
+	CuckooFilter(CuckooFilter<T, Hash>&& other)
+		: buckets{other.buckets}
+		, size_{other.size_}
+		, victim{other.victim}
+		, data{std::move(other.data)} {
+		other.buckets = 0;
+		other.size_ = 0;
+		other.victim.used = false;
+	}
+
+	CuckooFilter<T, Hash>& operator=(const CuckooFilter<T, Hash>& other) {
+		CuckooFilter<T, Hash> copy{other};
+		*this = std::move(copy);
+		return *this;
+	}
+
+	CuckooFilter<T, Hash>& operator=(CuckooFilter<T, Hash>&& other) {
+		CuckooFilter<T, Hash> moved{std::move(other)};
+		std::swap(buckets, moved.buckets);
+		std::swap(size_, moved.size_);
+		std::swap(victim, moved.victim);
+		std::swap(data, moved.data);
+		return *this;
+	}
+
+	/**
+	 * @brief Adds `data` to the filter
+	 *
+	 * @details A moved-from filter, which has no buckets, gets one.
+	 *
+	 * @return false if the filter is full and `data` was not added
+	 */
+	bool insert(const T& data_) {
+		if (buckets == 0)
+			*this = CuckooFilter<T, Hash>{};
+		if (victim.used)
+			return false;
+		std::uint64_t h = hash(data_);
+		insert_fingerprint(index(h), fingerprint(h));
+		return true;
+	}
+
+	/**
+	 * @brief Returns false if `data` was certainly not inserted
+	 */
+	bool contains(const T& data_) const {
+		if (buckets == 0)
+			return false;
+		std::uint64_t h = hash(data_);
+		Fingerprint f = fingerprint(h);
+		std::size_t i = index(h);
+		std::size_t k = alternate(i, f);
+		return has(i, f) || has(k, f) ||
+			   (victim.used && victim.fingerprint == f &&
+				(victim.index == i || victim.index == k));
+	}
+
+	/**
+	 * @brief Removes `data`, which must have been inserted, from the filter
+	 *
+	 * @return false if `data` was certainly not inserted, otherwise true
+	 */
+	bool remove(const T& data_) {
+		if (buckets == 0)
+			return false;
+		std::uint64_t h = hash(data_);
+		Fingerprint f = fingerprint(h);
+		std::size_t i = index(h);
+		std::size_t k = alternate(i, f);
+		if (victim.used && victim.fingerprint == f &&
+			(victim.index == i || victim.index == k)) {
+			victim.used = false;
+		} else if (!erase(i, f) && !erase(k, f)) {
+			return false;
+		}
+		size_--;
+
+		// a slot was freed, so the victim can go back in
+		if (victim.used) {
+			Victim v = victim;
+			victim.used = false;
+			size_--;
+			insert_fingerprint(v.index, v.fingerprint);
+		}
+		return true;
+	}
+
+	void clear() {
+		std::fill(data.get(), data.get() + buckets, Bucket{});
+		size_ = 0;
+		victim.used = false;
+	}
+
+	/**
+	 * @brief Number of fingerprints in the filter
+	 */
+	std::size_t size() const { return size_; }
+
+	/**
+	 * @brief Bytes used by the filter
+	 */
+	std::size_t memory_usage() const {
+		return sizeof(*this) + buckets * sizeof(Bucket);
+	}
+
+private:
+	using Fingerprint = std::uint16_t;
+
+	const static std::size_t slots{4};
+	const static std::size_t max_kicks{500};
+
+	struct Bucket {
+		Fingerprint fingerprints[slots];
+	};
+
+	struct Victim {
+		bool used;
+		Fingerprint fingerprint;
+		std::size_t index;
+	};
+
+	std::uint64_t hash(const T& data_) const {
+		return spread_hash<Hash>(hashf(data_));
+	}
+
+	// 0 marks an empty slot, so it is never a fingerprint
+	static Fingerprint fingerprint(std::uint64_t h) {
+		Fingerprint f = static_cast<Fingerprint>(h >> 48);
+		return f == 0 ? 1 : f;
+	}
+
+	std::size_t index(std::uint64_t h) const { return h & (buckets - 1); }
+
+	// an involution: the alternate of the alternate is the first bucket
+	std::size_t alternate(std::size_t i, Fingerprint f) const {
+		return (i ^ mix_hash(f)) & (buckets - 1);
+	}
+
+	bool add(std::size_t i, Fingerprint f) {
+		for (std::size_t j = 0; j < slots; j++) {
+			if (data[i].fingerprints[j] == 0) {
+				data[i].fingerprints[j] = f;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool has(std::size_t i, Fingerprint f) const {
+		bool found = false;
+		for (std::size_t j = 0; j < slots; j++)
+			found |= data[i].fingerprints[j] == f;
+		return found;
+	}
+
+	bool erase(std::size_t i, Fingerprint f) {
+		for (std::size_t j = 0; j < slots; j++) {
+			if (data[i].fingerprints[j] == f) {
+				data[i].fingerprints[j] = 0;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void insert_fingerprint(std::size_t i, Fingerprint f) {
+		size_++;
+		if (add(i, f) || add(alternate(i, f), f))
+			return;
+
+		// evicts fingerprints to their other bucket until one finds room
+		std::uint64_t random = mix_hash(i + f);
+		for (std::size_t kick = 0; kick < max_kicks; kick++) {
+			random = mix_hash(random + kick);
+			std::swap(f, data[i].fingerprints[random % slots]);
+			i = alternate(i, f);
+			if (add(i, f))
+				return;
+		}
+		// the last evicted fingerprint is kept aside, so it is not lost
+		victim = {true, f, i};
+	}
+
+	std::size_t buckets{1u};
+	std::size_t size_{0u};
+	Victim victim{false, 0, 0};
+	std::unique_ptr<Bucket[]> data;
+
+	Hash hashf{};
+};
+
+}  // namespace structures
+
+#endif
@@ -0,0 +1,317 @@
+#ifndef STRUCTURES_CUCKOO_HASH_TABLE_H
+#define STRUCTURES_CUCKOO_HASH_TABLE_H
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include <array_list.h>
+#include <traits.h>
+#include <utils.h>
+
+namespace structures {
+
+/**
+ * @brief Bucketized cuckoo HashTable, for high load factors
+ *
+ * @details Every element lives in one of two buckets of 4 slots, chosen by
+ * two halves of its hash, so a lookup reads at most two buckets whatever the
+ * load. When both buckets of a new element are full, it takes the place of
+ * an element of one of them, which moves to its other bucket, possibly
+ * evicting another one, and so on; the table grows only if this walk gets
+ * too long. With 4 slots per bucket this works up to about 98% of load.
+ *
+ * Elements are stored inline, next to one byte per bucket that tells which
+ * of its slots are full. The table grows when it is 95% full, a factor that
+ * set_max_load_factor changes, and shrinks when it is less than a quarter
+ * full.
+ *
+ * @tparam T    Data type of the elements
+ * @tparam Hash Class that implements the hash function
+ */
+template <typename T, typename Hash = std::hash<T>>
+class CuckooHashTableWrapper {
+public:
+	CuckooHashTableWrapper() = default;
+
+	CuckooHashTableWrapper(const CuckooHashTableWrapper<T, Hash>& other)
+		: max_load{other.max_load} {
+		// same capacity, so every element goes back to the same slot
+		if (other.size_ > 0) {
+			allocate(other.buckets_size);
+			for (std::size_t b = 0; b < buckets_size; b++) {
+				for (std::size_t j = 0; j < slots; j++)
+					if (other.full(b, j))
+						new (&buckets[b].slots[j]) T(other.slot(b, j));
+				used[b] = other.used[b];
+			}
+			size_ = other.size_;
+		}
+	}
+
+	CuckooHashTableWrapper(CuckooHashTableWrapper<T, Hash>&& other)
+		: used{std::move(other.used)}
+		, buckets{std::move(other.buckets)}
+		, buckets_size{other.buckets_size}
+		, size_{other.size_}
+		, max_load{other.max_load} {
+		other.buckets_size = 0;
+		other.size_ = 0;
+	}
+
+	CuckooHashTableWrapper<T, Hash>& operator=(
+		const CuckooHashTableWrapper<T, Hash>& other) {
+		CuckooHashTableWrapper<T, Hash> copy{other};
+		swap(copy);
+		return *this;
+	}
+
+	CuckooHashTableWrapper<T, Hash>& operator=(
+		CuckooHashTableWrapper<T, Hash>&& other) {
+		CuckooHashTableWrapper<T, Hash> copy{std::move(other)};
+		swap(copy);
+		return *this;
+	}
+
+	~CuckooHashTableWrapper() { destroy_all(); }
+
+	/**
+	 * @brief Inserts `data` into the table
+	 *
+	 * @return false if `data` was already in the table, otherwise true
+	 */
+	bool insert(const T& data) {
+		std::uint64_t h = hash(data);
+		if (find(data, h).first != buckets_size)
+			return false;
+		if (size_ + 1 > buckets_size * slots * max_load)
+			rehash(2 * buckets_size);
+		place(h, T(data));
+		return true;
+	}
+
+	/**
+	 * @brief Removes `data` from the table
+	 *
+	 * @return false if `data` was not in the table, otherwise true
+	 */
+	bool remove(const T& data) {
+		auto at = find(data, hash(data));
+		if (at.first == buckets_size)
+			return false;
+		slot(at.first, at.second).~T();
+		used[at.first] &= ~(1u << at.second);
+		size_--;
+
+		if (buckets_size > starting_size && size_ < buckets_size * slots / 4)
+			rehash(buckets_size / 2);
+		return true;
+	}
+
+	/**
+	 * @brief Returns true if the element is in the table
+	 */
+	bool contains(const T& data) const {
+		return find(data, hash(data)).first != buckets_size;
+	}
+
+	void clear() {
+		CuckooHashTableWrapper<T, Hash> empty;
+		empty.max_load = max_load;
+		swap(empty);
+	}
+
+	std::size_t size() const { return size_; }
+
+	/**
+	 * @brief Fraction of the slots that hold an element
+	 */
+	double load_factor() const {
+		return buckets_size
+				   ? static_cast<double>(size_) / (buckets_size * slots)
+				   : 0;
+	}
+
+	/**
+	 * @brief Sets the load factor at which the table grows, below 1
+	 */
+	void set_max_load_factor(double factor) { max_load = factor; }
+
+	/**
+	 * @brief Approximate amount of bytes used by the table
+	 */
+	std::size_t memory_usage() const {
+		return sizeof(*this) + buckets_size * (sizeof(Bucket) + 1);
+	}
+
+	/**
+	 * @brief Returns a list of the items that are on the table
+	 */
+	ArrayList<T> items() const {
+		ArrayList<T> al{size_ + 1};
+		for (std::size_t b = 0; b < buckets_size; b++)
+			for (std::size_t j = 0; j < slots; j++)
+				if (full(b, j))
+					al.push_back(slot(b, j));
+		return al;
+	}
+
+private:
+	using Storage =
+		typename std::aligned_storage<sizeof(T), alignof(T)>::type;
+
+	const static std::size_t slots{4};
+	const static std::size_t starting_size{4};
+	const static std::size_t max_kicks{500};
+
+	struct Bucket {
+		Storage slots[CuckooHashTableWrapper::slots];
+	};
+
+	std::uint64_t hash(const T& data) const {
+		return spread_hash<Hash>(hashf(data));
+	}
+
+	std::size_t first_bucket(std::uint64_t h) const {
+		return h & (buckets_size - 1);
+	}
+
+	// mixed again, since the low bits of a weak hash would make the two
+	// buckets of many elements related
+	std::size_t second_bucket(std::uint64_t h) const {
+		return mix_hash((h >> 32) | (h << 32)) & (buckets_size - 1);
+	}
+
+	bool full(std::size_t b, std::size_t j) const {
+		return used[b] & (1u << j);
+	}
+
+	T& slot(std::size_t b, std::size_t j) {
+		return *reinterpret_cast<T*>(&buckets[b].slots[j]);
+	}
+
+	const T& slot(std::size_t b, std::size_t j) const {
+		return *reinterpret_cast<const T*>(&buckets[b].slots[j]);
+	}
+
+	// the bucket and slot of `data`, or the amount of buckets if it is not
+	// in the table
+	std::pair<std::size_t, std::size_t> find(
+		const T& data, std::uint64_t h) const {
+		if (size_ == 0)
+			return {buckets_size, 0};
+		std::size_t b1 = first_bucket(h), b2 = second_bucket(h);
+		prefetch(&buckets[b2]);
+		for (std::size_t j = 0; j < slots; j++)
+			if (full(b1, j) && slot(b1, j) == data)
+				return {b1, j};
+		for (std::size_t j = 0; j < slots; j++)
+			if (full(b2, j) && slot(b2, j) == data)
+				return {b2, j};
+		return {buckets_size, 0};
+	}
+
+	// builds `data` in a free slot of bucket `b`, if there is one
+	bool add(std::size_t b, T& data) {
+		for (std::size_t j = 0; j < slots; j++) {
+			if (!full(b, j)) {
+				new (&buckets[b].slots[j]) T(std::move(data));
+				used[b] |= 1u << j;
+				size_++;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// inserts an element that is not in the table, growing it if needed
+	void place(std::uint64_t h, T&& data) {
+		T carried{std::move(data)};
+		std::size_t b = first_bucket(h);
+		if (add(b, carried) || add(second_bucket(h), carried))
+			return;
+
+		// evicts a random element to its other bucket until one has room
+		std::uint64_t random = h;
+		for (std::size_t kick = 0; kick < max_kicks; kick++) {
+			random = mix_hash(random + kick);
+			std::swap(carried, slot(b, random % slots));
+			std::uint64_t hc = hash(carried);
+			b = b == first_bucket(hc) ? second_bucket(hc) : first_bucket(hc);
+			if (add(b, carried))
+				return;
+		}
+		rehash(2 * buckets_size);
+		place(hash(carried), std::move(carried));
+	}
+
+	void allocate(std::size_t new_buckets) {
+		used.reset(new std::uint8_t[new_buckets]);
+		std::memset(used.get(), 0, new_buckets);
+		buckets.reset(new Bucket[new_buckets]);
+		buckets_size = new_buckets;
+	}
+
+	// moves the elements to a table with `new_buckets` buckets
+	void rehash(std::size_t new_buckets) {
+		if (new_buckets < starting_size)
+			new_buckets = starting_size;
+
+		CuckooHashTableWrapper<T, Hash> table;
+		table.max_load = max_load;
+		table.allocate(new_buckets);
+		for (std::size_t b = 0; b < buckets_size; b++) {
+			for (std::size_t j = 0; j < slots; j++) {
+				if (full(b, j)) {
+					table.place(hash(slot(b, j)), std::move(slot(b, j)));
+					slot(b, j).~T();
+				}
+			}
+			used[b] = 0;
+		}
+		size_ = 0;
+		swap(table);
+	}
+
+	void destroy_all() {
+		for (std::size_t b = 0; b < buckets_size; b++)
+			for (std::size_t j = 0; j < slots; j++)
+				if (full(b, j))
+					slot(b, j).~T();
+	}
+
+	void swap(CuckooHashTableWrapper<T, Hash>& other) {
+		std::swap(used, other.used);
+		std::swap(buckets, other.buckets);
+		std::swap(buckets_size, other.buckets_size);
+		std::swap(size_, other.size_);
+		std::swap(max_load, other.max_load);
+	}
+
+	std::unique_ptr<std::uint8_t[]> used;
+	std::unique_ptr<Bucket[]> buckets;
+	std::size_t buckets_size{0u};
+	std::size_t size_{0u};
+	double max_load{0.95};
+
+	Hash hashf{};
+};
+
+template <typename T>
+class CuckooHashTable : public CuckooHashTableWrapper<T> {};
+
+}  // namespace structures
+
+/* set trait */
+template <>
+const bool traits::is_set<structures::CuckooHashTable>::value = true;
+
+/* name trait */
+template <>
+const std::string traits::type<structures::CuckooHashTable>::name =
+	"CuckooHashTable";
+
+#endif
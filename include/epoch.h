@@ -0,0 +1,239 @@
+#ifndef STRUCTURES_EPOCH_H
+#define STRUCTURES_EPOCH_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+#include <array_list.h>
+
+namespace structures {
+
+/**
+ * @brief Epoch based memory reclamation for concurrent structures
+ *
+ * @details Lock-free readers may still be reading a node after a writer
+ * removed it from a structure, so removed nodes are not deleted right away,
+ * they are `retire`d instead. Threads `pin` the current epoch (using a
+ * Guard) while they access a structure, and the global epoch only advances
+ * when every pinned thread has seen it. A node retired at epoch `e` is
+ * therefore deleted once the global epoch reaches `e + 2`.
+ */
+namespace epoch {
+
+/**
+ * @brief An object waiting to be deleted
+ */
+struct Retired {
+	void* object{nullptr};
+	void (*deleter)(void*){nullptr};
+	std::uint64_t epoch{0};
+
+	void destroy() { deleter(object); }
+};
+
+/**
+ * @brief Global epoch, and the epochs pinned by each thread
+ */
+class Domain {
+public:
+	/**
+	 * @brief Per thread record, it is reused after its thread exits
+	 */
+	struct Record {
+		// (epoch << 1) | 1 while pinned, 0 otherwise
+		std::atomic<std::uint64_t> pinned{0};
+		std::atomic<bool> used{true};
+		Record* next{nullptr};
+	};
+
+	Domain() = default;
+	Domain(const Domain&) = delete;
+	Domain& operator=(const Domain&) = delete;
+
+	~Domain() {
+		for (std::size_t i = 0; i < orphans.size(); i++)
+			orphans[i].destroy();
+		while (records) {
+			auto next = records.load()->next;
+			delete records.load();
+			records = next;
+		}
+	}
+
+	/**
+	 * @brief The domain shared by all the concurrent structures
+	 */
+	static Domain& global() {
+		static Domain domain;
+		return domain;
+	}
+
+	std::uint64_t current() const { return epoch; }
+
+	Record* acquire() {
+		for (Record* r = records; r; r = r->next) {
+			bool expected = false;
+			if (!r->used && r->used.compare_exchange_strong(expected, true))
+				return r;
+		}
+		auto r = new Record;
+		r->next = records;
+		while (!records.compare_exchange_weak(r->next, r)) {
+		}
+		return r;
+	}
+
+	void release(Record* r) {
+		r->pinned = 0;
+		r->used = false;
+	}
+
+	/**
+	 * @brief Advances the global epoch if every pinned thread has seen it
+	 *
+	 * @return The global epoch
+	 */
+	std::uint64_t try_advance() {
+		std::uint64_t e = epoch;
+		for (Record* r = records; r; r = r->next) {
+			std::uint64_t p = r->pinned;
+			if (p != 0 && p >> 1 != e)
+				return e;
+		}
+		epoch.compare_exchange_strong(e, e + 1);
+		collect_orphans();
+		return epoch;
+	}
+
+	/**
+	 * @brief Takes the objects retired by a thread that is exiting
+	 */
+	void adopt(ArrayList<Retired>& retired) {
+		std::lock_guard<std::mutex> lock{orphans_mutex};
+		for (std::size_t i = 0; i < retired.size(); i++)
+			orphans.push_back(retired[i]);
+		retired.clear();
+	}
+
+private:
+	void collect_orphans() {
+		std::lock_guard<std::mutex> lock{orphans_mutex};
+		std::size_t kept = 0;
+		for (std::size_t i = 0; i < orphans.size(); i++) {
+			if (orphans[i].epoch + 2 <= epoch)
+				orphans[i].destroy();
+			else
+				orphans[kept++] = orphans[i];
+		}
+		while (orphans.size() > kept)
+			orphans.pop_back();
+	}
+
+	std::atomic<std::uint64_t> epoch{1};
+	std::atomic<Record*> records{nullptr};
+	std::mutex orphans_mutex;
+	ArrayList<Retired> orphans;
+};
+
+/**
+ * @brief State of the current thread: its record and its retired objects
+ */
+class Participant {
+public:
+	explicit Participant(Domain& domain_)
+		: domain{domain_}, record{domain.acquire()} {}
+
+	Participant(const Participant&) = delete;
+	Participant& operator=(const Participant&) = delete;
+
+	~Participant() {
+		domain.adopt(retired);
+		domain.release(record);
+	}
+
+	void pin() {
+		if (pins++ > 0)
+			return;
+		// the epoch may advance between reading and publishing it
+		std::uint64_t e;
+		do {
+			e = domain.current();
+			record->pinned = (e << 1) | 1;
+		} while (domain.current() != e);
+	}
+
+	void unpin() {
+		if (--pins == 0)
+			record->pinned.store(0, std::memory_order_release);
+	}
+
+	void retire(void* object, void (*deleter)(void*)) {
+		retired.push_back({object, deleter, domain.current()});
+		if (retired.size() % collect_period == 0)
+			collect();
+	}
+
+	/**
+	 * @brief Deletes the retired objects that can no longer be reached
+	 */
+	void collect() {
+		std::uint64_t e = domain.try_advance();
+		std::size_t kept = 0;
+		for (std::size_t i = 0; i < retired.size(); i++) {
+			if (retired[i].epoch + 2 <= e)
+				retired[i].destroy();
+			else
+				retired[kept++] = retired[i];
+		}
+		while (retired.size() > kept)
+			retired.pop_back();
+	}
+
+private:
+	const static std::size_t collect_period{64};
+
+	Domain& domain;
+	Domain::Record* record;
+	std::size_t pins{0u};
+	ArrayList<Retired> retired;
+};
+
+/**
+ * @brief The participant of the calling thread in the global domain
+ */
+inline Participant& local() {
+	static thread_local Participant participant{Domain::global()};
+	return participant;
+}
+
+/**
+ * @brief Pins the current epoch while in scope, guards may be nested
+ */
+class Guard {
+public:
+	Guard() : participant{local()} { participant.pin(); }
+	Guard(const Guard&) = delete;
+	Guard& operator=(const Guard&) = delete;
+	~Guard() { participant.unpin(); }
+
+private:
+	Participant& participant;
+};
+
+/**
+ * @brief Deletes `object` once no thread can be reading it
+ *
+ * @details The caller must have already made `object` unreachable.
+ */
+template <typename T>
+void retire(T* object) {
+	local().retire(
+		object, [](void* p) { delete static_cast<T*>(p); });
+}
+
+}  // namespace epoch
+
+}  // namespace structures
+
+#endif
@@ -0,0 +1,178 @@
+#ifndef STRUCTURES_EXTERNAL_PRIORITY_QUEUE_H
+#define STRUCTURES_EXTERNAL_PRIORITY_QUEUE_H
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include <array_list.h>
+#include <external_sort.h>
+#include <heap.h>
+#include <k_way_merge.h>
+#include <traits.h>
+
+namespace structures {
+
+/**
+ * @brief A priority queue that holds more elements than fit in memory
+ *
+ * @details Pushed elements go to a Heap. When the heap reaches half of the
+ * memory budget, it is written to a temporary file as a sorted run, larger
+ * elements first. The runs are merged by a KWayMerge, and pop takes the
+ * larger of the top of the heap and the head element of the merge, which is
+ * kept aside for the comparison. So pushes and pops work in memory, and runs
+ * are only read a buffer at a time, sequentially.
+ *
+ * The other half of the budget is for the buffers of the runs being merged.
+ * When there are more runs than buffers, the runs are merged into one. The
+ * runs share one temporary file, and merging them starts a new one, which
+ * frees the space of the merged runs.
+ *
+ * @tparam          T Data type of the elements, trivially copyable
+ * @tparam Comparator Type providing a strict weak ordering function
+ */
+template <typename T, typename Comparator = std::less<T>>
+class ExternalPriorityQueueWrapper {
+public:
+	/**
+	 * @brief A queue that keeps about `memory_budget` bytes in memory, and
+	 * reads and writes files `buffer_size` bytes at a time
+	 *
+	 * @details The buffers are at most a quarter of the budget, so that at
+	 * least two runs are merged before they are compacted.
+	 */
+	explicit ExternalPriorityQueueWrapper(
+		std::size_t memory_budget = std::size_t{64} << 20,
+		std::size_t buffer_size = std::size_t{1} << 20) {
+		buffer_size = std::max<std::size_t>(
+			1, std::min(buffer_size, memory_budget / 4));
+		capacity = std::max<std::size_t>(1, memory_budget / 2 / sizeof(T));
+		buffer_elements = std::max<std::size_t>(1, buffer_size / sizeof(T));
+		max_runs = std::max<std::size_t>(2, memory_budget / 2 / buffer_size);
+		// spill pushes the head too
+		heap.reserve(capacity + 1);
+	}
+
+	/**
+	 * @brief Inserts an element into the queue
+	 */
+	void push(const T& data) {
+		heap.push(data);
+		size_++;
+		if (heap.size() >= capacity)
+			spill();
+	}
+
+	/**
+	 * @brief Removes the top, i.e. the larger, element of the queue
+	 *
+	 * @return The removed element
+	 */
+	T pop() {
+		if (size_ == 0)
+			throw std::out_of_range("Queue is empty");
+		size_--;
+		if (!has_head || (heap.size() > 0 && !comp(heap.top(), head)))
+			return heap.pop();
+		T out = head;
+		has_head = merge.next(head);
+		return out;
+	}
+
+	/**
+	 * @brief const ref to the top element of the queue
+	 */
+	const T& top() const {
+		if (!has_head || (heap.size() > 0 && !comp(heap.top(), head)))
+			return heap.top();
+		return head;
+	}
+
+	std::size_t size() const { return size_; }
+
+	/**
+	 * @brief Amount of runs written to disk so far
+	 */
+	std::size_t runs_written() const { return runs_written_; }
+
+private:
+	// puts the smaller element on top, so that runs are written in the
+	// order of the merge
+	struct Reversed {
+		bool operator()(const T& a, const T& b) const { return comp(b, a); }
+
+		Comparator comp;
+	};
+
+	using Run = detail::Run<T>;
+
+	// writes the heap as a new run, with the element kept aside from the
+	// merge, which may be smaller than the new run's
+	void spill() {
+		if (has_head)
+			heap.push(head);
+		has_head = false;
+		if (runs.size() == max_runs)
+			compact();
+
+		if (!file)
+			file = std::make_shared<detail::RunFile>();
+		auto run = std::make_unique<Run>(file, buffer_elements);
+		runs_written_++;
+		while (heap.size() > 0)
+			run->write(heap.pop());
+		// popping shrank the heap
+		heap.reserve(capacity + 1);
+		run->rewind();
+		add(*run);
+		runs.push_back(std::move(run));
+		has_head = merge.next(head);
+	}
+
+	// merges every run into one
+	void compact() {
+		file = std::make_shared<detail::RunFile>();
+		auto run = std::make_unique<Run>(file, buffer_elements);
+		runs_written_++;
+		T data;
+		while (merge.next(data))
+			run->write(data);
+		run->rewind();
+		runs = ArrayList<std::unique_ptr<Run>>{};
+		merge = KWayMergeWrapper<T, Reversed>{};
+		add(*run);
+		runs.push_back(std::move(run));
+	}
+
+	void add(Run& run) {
+		merge.add([&run](T& out) { return run.read(out); });
+	}
+
+	HeapWrapper<T, Comparator> heap;
+	std::shared_ptr<detail::RunFile> file;
+	ArrayList<std::unique_ptr<Run>> runs;
+	KWayMergeWrapper<T, Reversed> merge;
+	T head;
+	bool has_head{false};
+	std::size_t capacity, buffer_elements, max_runs;
+	std::size_t runs_written_{0u};
+	std::size_t size_{0u};
+	Comparator comp;
+};
+
+template <typename T>
+class ExternalPriorityQueue : public ExternalPriorityQueueWrapper<T> {
+public:
+	using ExternalPriorityQueueWrapper<T>::ExternalPriorityQueueWrapper;
+};
+
+}  // namespace structures
+
+/* name trait */
+template <>
+const std::string traits::type<structures::ExternalPriorityQueue>::name =
+	"ExternalPriorityQueue";
+
+#endif
@@ -0,0 +1,336 @@
+#ifndef STRUCTURES_EXTERNAL_SORT_H
+#define STRUCTURES_EXTERNAL_SORT_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include <array_list.h>
+#include <heap.h>
+#include <k_way_merge.h>
+#include <traits.h>
+
+namespace structures {
+
+namespace detail {
+
+/**
+ * @brief A temporary file that holds runs one after another, deleted when
+ * closed
+ */
+struct RunFile {
+	RunFile() : file{std::tmpfile()} {
+		if (!file)
+			throw std::runtime_error("Could not create a temporary file");
+	}
+
+	struct Closer {
+		void operator()(std::FILE* f) const { std::fclose(f); }
+	};
+
+	std::unique_ptr<std::FILE, Closer> file;
+	std::uint64_t end{0u};  // bytes taken by the runs written so far
+};
+
+/**
+ * @brief A sequence of elements in a temporary file, written once and then
+ * read once, through a buffer of a fixed amount of elements
+ *
+ * @details The buffer exists only while the run is being written or read,
+ * so runs waiting to be merged take no memory. Runs may share a file, so
+ * that many runs do not take as many file descriptors, and the file is
+ * deleted when its last run is destroyed.
+ */
+template <typename T>
+class Run {
+	static_assert(
+		std::is_trivially_copyable<T>::value,
+		"elements are written to files as bytes");
+
+public:
+	/**
+	 * @brief A run in a file of its own
+	 */
+	explicit Run(std::size_t buffer_size)
+		: Run(std::make_shared<RunFile>(), buffer_size) {}
+
+	/**
+	 * @brief A run after the other runs of `file`, which must be rewound
+	 */
+	Run(std::shared_ptr<RunFile> file, std::size_t buffer_size)
+		: file{std::move(file)}
+		, start{this->file->end}
+		, buffer{new T[buffer_size]}
+		, buffer_size{buffer_size} {}
+
+	void write(const T& data) {
+		buffer[used++] = data;
+		size_++;
+		if (used == buffer_size)
+			flush();
+	}
+
+	/**
+	 * @brief Ends the writing, after which the run may be read
+	 */
+	void rewind() {
+		flush();
+		buffer.reset();
+	}
+
+	/**
+	 * @brief Reads the next element into `out`
+	 *
+	 * @return false if the run was read to its end, otherwise true
+	 */
+	bool read(T& out) {
+		if (next == used) {
+			if (taken == size_) {
+				buffer.reset();
+				return false;
+			}
+			if (!buffer)
+				buffer.reset(new T[buffer_size]);
+			used = std::min(buffer_size, size_ - taken);
+			seek(taken);
+			if (std::fread(buffer.get(), sizeof(T), used, file->file.get()) !=
+				used)
+				throw std::runtime_error("Could not read a temporary file");
+			taken += used;
+			next = 0;
+		}
+		out = buffer[next++];
+		return true;
+	}
+
+	std::size_t size() const { return size_; }
+
+private:
+	void flush() {
+		seek(size_ - used);
+		if (std::fwrite(buffer.get(), sizeof(T), used, file->file.get()) !=
+			used)
+			throw std::runtime_error("Could not write a temporary file");
+		file->end = start + size_ * sizeof(T);
+		used = 0;
+	}
+
+	// moves the position of the file to the element `i` of the run
+	void seek(std::size_t i) {
+		long offset = static_cast<long>(start + i * sizeof(T));
+		if (std::fseek(file->file.get(), offset, SEEK_SET) != 0)
+			throw std::runtime_error("Could not seek a temporary file");
+	}
+
+	std::shared_ptr<RunFile> file;
+	std::uint64_t start;  // byte offset of the run in the file
+	std::unique_ptr<T[]> buffer;
+	std::size_t buffer_size;
+	std::size_t used{0u};   // elements in the buffer
+	std::size_t next{0u};   // next element of the buffer to be read
+	std::size_t taken{0u};  // elements read from the file
+	std::size_t size_{0u};
+};
+
+}  // namespace detail
+
+/**
+ * @brief Sorts more elements than fit in memory
+ *
+ * @details Elements are pushed one at a time, and read back sorted with
+ * next. Up to the memory budget, they are kept in a Heap. Beyond it, every
+ * push writes the smaller element of the heap to a sorted run in a
+ * temporary file (replacement selection): a pushed element that is smaller
+ * than the last one written waits for the next run, the others may still go
+ * to the current one. On random input this makes runs of about twice as
+ * many elements as fit in the budget, and sorted input is a single run.
+ *
+ * Once the output starts, the runs are merged with a KWayMerge. With more
+ * runs than buffers fit in the budget, runs are first merged in groups into
+ * longer runs. Files are read and written sequentially, a buffer at a time.
+ * The runs of each pass share one temporary file, so only a few files are
+ * open at once however many runs there are.
+ *
+ * If nothing was written to disk, the elements come straight from the heap.
+ *
+ * @tparam          T Data type of the elements, trivially copyable
+ * @tparam Comparator Type providing a strict weak ordering function
+ */
+template <typename T, typename Comparator = std::less<T>>
+class ExternalSorterWrapper {
+public:
+	/**
+	 * @brief A sorter that keeps about `memory_budget` bytes in memory, and
+	 * reads and writes files `buffer_size` bytes at a time
+	 *
+	 * @details The buffers are at most a quarter of the budget, so that at
+	 * least three runs are merged at once.
+	 */
+	explicit ExternalSorterWrapper(
+		std::size_t memory_budget = std::size_t{64} << 20,
+		std::size_t buffer_size = std::size_t{1} << 20) {
+		buffer_size = std::max<std::size_t>(
+			1, std::min(buffer_size, memory_budget / 4));
+		capacity = memory_budget > buffer_size
+			? std::max<std::size_t>(
+				  1, (memory_budget - buffer_size) / sizeof(Entry))
+			: 1;
+		buffer_elements = std::max<std::size_t>(1, buffer_size / sizeof(T));
+		fan_in = std::max<std::size_t>(4, memory_budget / buffer_size) - 1;
+		heap.reserve(capacity);
+	}
+
+	/**
+	 * @brief Adds an element to be sorted, before the output started
+	 */
+	void push(const T& data) {
+		if (started)
+			throw std::logic_error("Push after the output started");
+		size_++;
+		if (heap.size() < capacity) {
+			heap.push(Entry{0, data});
+			return;
+		}
+		const Entry& top = heap.top();
+		write(top);
+		std::size_t run = comp(data, top.data) ? top.run + 1 : top.run;
+		heap.replace_top(Entry{run, data});
+	}
+
+	/**
+	 * @brief Takes the next element of the sorted output into `out`
+	 *
+	 * @return false if every element was taken, otherwise true
+	 */
+	bool next(T& out) {
+		if (!started)
+			start();
+		if (runs.empty()) {
+			if (heap.size() == 0)
+				return false;
+			out = heap.pop().data;
+		} else if (!merge.next(out)) {
+			return false;
+		}
+		size_--;
+		return true;
+	}
+
+	/**
+	 * @brief Amount of elements not taken yet
+	 */
+	std::size_t size() const { return size_; }
+
+	/**
+	 * @brief Amount of runs written to disk so far
+	 */
+	std::size_t runs_written() const { return runs_written_; }
+
+private:
+	struct Entry {
+		std::size_t run;
+		T data;
+	};
+
+	// puts the entry of the earlier run, and then of the smaller element,
+	// on top of the heap
+	struct EntryAfter {
+		bool operator()(const Entry& a, const Entry& b) const {
+			if (a.run != b.run)
+				return a.run > b.run;
+			return comp(b.data, a.data);
+		}
+
+		Comparator comp;
+	};
+
+	using Run = detail::Run<T>;
+
+	// the runs all go to one file, so that they take a single descriptor
+	void write(const Entry& entry) {
+		if (runs.empty() || entry.run > current_run) {
+			if (runs.empty())
+				file = std::make_shared<detail::RunFile>();
+			else
+				runs.back()->rewind();
+			runs.push_back(std::make_unique<Run>(file, buffer_elements));
+			runs_written_++;
+			current_run = entry.run;
+		}
+		runs.back()->write(entry.data);
+	}
+
+	void start() {
+		started = true;
+		if (runs.empty())
+			return;
+		while (heap.size() > 0)
+			write(heap.pop());
+		runs.back()->rewind();
+		file.reset();
+
+		// merges groups of runs until every run has its buffer, writing the
+		// merged runs of each pass to a new file
+		while (runs.size() > fan_in) {
+			auto output = std::make_shared<detail::RunFile>();
+			ArrayList<std::unique_ptr<Run>> merged;
+			for (std::size_t i = 0; i < runs.size(); i += fan_in) {
+				std::size_t end = std::min(i + fan_in, runs.size());
+				if (end - i == 1) {
+					merged.push_back(std::move(runs[i]));
+					continue;
+				}
+				KWayMergeWrapper<T, Comparator> group;
+				for (std::size_t j = i; j < end; j++)
+					add(group, *runs[j]);
+				auto run = std::make_unique<Run>(output, buffer_elements);
+				runs_written_++;
+				T data;
+				while (group.next(data))
+					run->write(data);
+				run->rewind();
+				merged.push_back(std::move(run));
+				for (std::size_t j = i; j < end; j++)
+					runs[j].reset();
+			}
+			runs = std::move(merged);
+		}
+		for (std::size_t i = 0; i < runs.size(); i++)
+			add(merge, *runs[i]);
+	}
+
+	static void add(KWayMergeWrapper<T, Comparator>& to, Run& run) {
+		to.add([&run](T& out) { return run.read(out); });
+	}
+
+	HeapWrapper<Entry, EntryAfter> heap;
+	std::shared_ptr<detail::RunFile> file;
+	ArrayList<std::unique_ptr<Run>> runs;
+	KWayMergeWrapper<T, Comparator> merge;
+	std::size_t capacity, buffer_elements, fan_in;
+	std::size_t current_run{0u};
+	std::size_t runs_written_{0u};
+	std::size_t size_{0u};
+	bool started{false};
+	Comparator comp;
+};
+
+template <typename T>
+class ExternalSorter : public ExternalSorterWrapper<T> {
+public:
+	using ExternalSorterWrapper<T>::ExternalSorterWrapper;
+};
+
+}  // namespace structures
+
+/* name trait */
+template <>
+const std::string traits::type<structures::ExternalSorter>::name =
+	"ExternalSorter";
+
+#endif
@@ -0,0 +1,128 @@
+#ifndef STRUCTURES_FILTERED_SET_H
+#define STRUCTURES_FILTERED_SET_H
+
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+
+#include <array_list.h>
+#include <bloom_filter.h>
+#include <cuckoo_filter.h>
+#include <traits.h>
+
+namespace structures {
+
+/**
+ * @brief A set with a filter in front of it
+ *
+ * @details Every element of the set is also inserted in a BloomFilter or a
+ * CuckooFilter, and `contains` only searches the set when the filter answers
+ * true, so most lookups of absent elements never touch the set. This pays
+ * off when the set is slow to search (e.g. a tree, or a table larger than
+ * the cache) and most lookups miss.
+ *
+ * The filter is rebuilt from the elements of the set, with room for twice
+ * as many, when the set outgrows it or a CuckooFilter gets full. Removals
+ * are forwarded to a CuckooFilter; a BloomFilter keeps the bits of removed
+ * elements, so it is also rebuilt once those make up half of its capacity.
+ *
+ * @tparam T Data type of the elements
+ * @tparam S The set, any structure with the set trait
+ * @tparam F The filter, BloomFilter or CuckooFilter
+ */
+template <
+	typename T, template <typename> class S,
+	template <typename> class F = BloomFilter>
+class FilteredSet {
+	static_assert(traits::is_set<S>::value, "S must be a set");
+
+	template <typename G, typename = void>
+	struct removable : std::false_type {};
+
+	template <typename G>
+	struct removable<
+		G, std::void_t<decltype(std::declval<G&>().remove(std::declval<T>()))>>
+		: std::true_type {};
+
+public:
+	/**
+	 * @brief Inserts `data` into the set and the filter
+	 *
+	 * @return false if `data` was already in the set, otherwise true
+	 */
+	bool insert(const T& data) {
+		if (!set_.insert(data))
+			return false;
+		if (set_.size() + stale > capacity || !filter_.insert(data))
+			rebuild();
+		return true;
+	}
+
+	/**
+	 * @brief Removes `data` from the set and, if it can, from the filter
+	 *
+	 * @return false if `data` was not in the set, otherwise true
+	 */
+	bool remove(const T& data) {
+		if (!set_.remove(data))
+			return false;
+		if constexpr (removable<F<T>>::value)
+			filter_.remove(data);
+		else if (++stale > capacity / 2)
+			rebuild();
+		return true;
+	}
+
+	/**
+	 * @brief Returns true if `data` is in the set, searching it only if the
+	 * filter does not rule `data` out
+	 */
+	bool contains(const T& data) const {
+		return filter_.contains(data) && set_.contains(data);
+	}
+
+	void clear() {
+		set_.clear();
+		filter_.clear();
+		stale = 0;
+	}
+
+	std::size_t size() const { return set_.size(); }
+
+	const S<T>& set() const { return set_; }
+
+	const F<T>& filter() const { return filter_; }
+
+	/**
+	 * @brief Returns a list of the items that are on the set
+	 */
+	ArrayList<T> items() const { return set_.items(); }
+
+private:
+	constexpr static std::size_t starting_capacity{64};
+
+	void rebuild() {
+		auto list = set_.items();
+		capacity = std::max<std::size_t>(starting_capacity, 2 * list.size());
+		while (!fill(list))
+			capacity *= 2;
+		stale = 0;
+	}
+
+	bool fill(const ArrayList<T>& list) {
+		filter_ = F<T>{capacity};
+		for (std::size_t i = 0; i < list.size(); i++)
+			if (!filter_.insert(list[i]))
+				return false;
+		return true;
+	}
+
+	S<T> set_;
+	std::size_t capacity{starting_capacity};
+	std::size_t stale{0u};  // removed elements still in the filter
+	F<T> filter_{starting_capacity};
+};
+
+}  // namespace structures
+
+#endif
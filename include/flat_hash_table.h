@@ -0,0 +1,503 @@
+#ifndef STRUCTURES_FLAT_HASH_TABLE_H
+#define STRUCTURES_FLAT_HASH_TABLE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <array_list.h>
+#include <traits.h>
+#include <utils.h>
+
+namespace structures {
+
+/**
+ * @brief Metadata of a group of 16 slots of an open addressing table
+ *
+ * @details Each slot has a control byte: empty, deleted, or 7 bits of the
+ * hash of its element. Matching a whole group against a byte is a single
+ * SSE2 comparison when available.
+ */
+class ControlGroup {
+public:
+	const static std::size_t width{16};
+
+	const static std::int8_t empty{-128};
+	const static std::int8_t deleted{-2};
+
+	explicit ControlGroup(const std::int8_t* ctrl) {
+#if defined(__SSE2__)
+		bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+#else
+		std::memcpy(bytes, ctrl, width);
+#endif
+	}
+
+	/**
+	 * @brief Bit mask of the slots whose control byte is `h2`
+	 */
+	std::uint32_t match(std::int8_t h2) const {
+#if defined(__SSE2__)
+		return _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(h2)));
+#else
+		std::uint32_t mask = 0;
+		for (std::size_t i = 0; i < width; i++)
+			mask |= std::uint32_t{bytes[i] == h2} << i;
+		return mask;
+#endif
+	}
+
+	/**
+	 * @brief Bit mask of the empty slots
+	 */
+	std::uint32_t match_empty() const { return match(empty); }
+
+	/**
+	 * @brief Bit mask of the empty or deleted slots
+	 */
+	std::uint32_t match_free() const {
+#if defined(__SSE2__)
+		return _mm_movemask_epi8(bytes);
+#else
+		std::uint32_t mask = 0;
+		for (std::size_t i = 0; i < width; i++)
+			mask |= std::uint32_t{bytes[i] < 0} << i;
+		return mask;
+#endif
+	}
+
+	/**
+	 * @brief Index of the lowest bit of a non zero mask
+	 */
+	static std::size_t lowest(std::uint32_t mask) {
+#if defined(__GNUC__)
+		return __builtin_ctz(mask);
+#else
+		std::size_t i = 0;
+		while (!(mask & 1)) {
+			mask >>= 1;
+			i++;
+		}
+		return i;
+#endif
+	}
+
+private:
+#if defined(__SSE2__)
+	__m128i bytes;
+#else
+	std::int8_t bytes[width];
+#endif
+};
+
+/**
+ * @brief Open addressing table of slots, the engine of FlatHashTable and
+ * HashMap
+ *
+ * @details Slots are stored inline in an array, next to an array of one
+ * control byte per slot, so there is no allocation per element and a lookup
+ * usually touches two cache lines. Slots are probed in groups of 16, which
+ * are compared at once against 7 bits of the hash of the key; only the
+ * slots that match are compared with `Eq`.
+ *
+ * Removed slots leave a tombstone behind, unless no probe ever went past
+ * their group. The table grows when it is 7/8 full, tombstones included.
+ *
+ * Lookups take any key type that `Hash` and `Eq` accept, so transparent
+ * function objects allow looking up without building a key.
+ *
+ * @tparam T     Data type of the slots
+ * @tparam KeyOf Function object that returns the key of a slot
+ * @tparam Hash  Class that implements the hash function of the keys
+ * @tparam Eq    Class that compares keys for equality
+ */
+template <typename T, typename KeyOf, typename Hash, typename Eq>
+class FlatTable {
+public:
+	FlatTable() = default;
+
+	FlatTable(const FlatTable<T, KeyOf, Hash, Eq>& other) {
+		if (other.size_ > 0) {
+			allocate(other.capacity_);
+			for (std::size_t i = 0; i < other.capacity_; i++)
+				if (other.full(i))
+					place(hash(keyf(other.slot(i))), other.slot(i));
+		}
+	}
+
+	FlatTable(FlatTable<T, KeyOf, Hash, Eq>&& other)
+		: ctrl{std::move(other.ctrl)}
+		, slots{std::move(other.slots)}
+		, capacity_{other.capacity_}
+		, size_{other.size_}
+		, tombstones{other.tombstones} {
+		other.capacity_ = 0;
+		other.size_ = 0;
+		other.tombstones = 0;
+	}
+
+	FlatTable<T, KeyOf, Hash, Eq>& operator=(
+		const FlatTable<T, KeyOf, Hash, Eq>& other) {
+		FlatTable<T, KeyOf, Hash, Eq> copy{other};
+		swap(copy);
+		return *this;
+	}
+
+	FlatTable<T, KeyOf, Hash, Eq>& operator=(
+		FlatTable<T, KeyOf, Hash, Eq>&& other) {
+		FlatTable<T, KeyOf, Hash, Eq> copy{std::move(other)};
+		swap(copy);
+		return *this;
+	}
+
+	~FlatTable() { destroy_all(); }
+
+	/**
+	 * @brief Returns the slot whose key is `key`, or capacity() if there is
+	 * none
+	 */
+	template <typename K>
+	std::size_t find(const K& key) const {
+		return find(key, hash(key));
+	}
+
+	/**
+	 * @brief Returns the slot whose key is `key`, whose hash is `h`, or
+	 * capacity() if there is none
+	 *
+	 * @details Groups are probed quadratically (1, 2, 3... groups apart),
+	 * which visits every group because the amount of groups is a power of 2.
+	 */
+	template <typename K>
+	std::size_t find(const K& key, std::uint64_t h) const {
+		if (capacity_ == 0)
+			return capacity_;
+
+		std::size_t mask = capacity_ / ControlGroup::width - 1;
+		std::size_t group = (h >> 7) & mask;
+		for (std::size_t step = 1;; step++) {
+			std::size_t first = group * ControlGroup::width;
+			ControlGroup g{&ctrl[first]};
+			for (auto m = g.match(h2(h)); m; m &= m - 1) {
+				std::size_t i = first + ControlGroup::lowest(m);
+				if (eq(keyf(slot(i)), key))
+					return i;
+			}
+			if (g.match_empty() || step > mask)
+				return capacity_;
+			group = (group + step) & mask;
+		}
+	}
+
+	template <typename K>
+	std::uint64_t hash(const K& key) const {
+		return spread_hash<Hash>(hashf(key));
+	}
+
+	/**
+	 * @brief Prefetches the first group that a key whose hash is `h` probes
+	 */
+	void prefetch(std::uint64_t h) const {
+		if (capacity_ == 0)
+			return;
+		std::size_t mask = capacity_ / ControlGroup::width - 1;
+		std::size_t first = ((h >> 7) & mask) * ControlGroup::width;
+		::prefetch(&ctrl[first]);
+		::prefetch(&slots[first]);
+	}
+
+	/**
+	 * @brief Builds a slot from `args` unless there is one with `key`
+	 *
+	 * @return The slot with `key`, and whether it was built
+	 */
+	template <typename K, typename... Args>
+	std::pair<std::size_t, bool> emplace(const K& key, Args&&... args) {
+		return emplace_hashed(hash(key), key, std::forward<Args>(args)...);
+	}
+
+	/**
+	 * @brief emplace() of a key whose hash is `h`
+	 */
+	template <typename K, typename... Args>
+	std::pair<std::size_t, bool> emplace_hashed(
+		std::uint64_t h, const K& key, Args&&... args) {
+		std::size_t i = find(key, h);
+		if (i != capacity_)
+			return {i, false};
+
+		if (size_ + tombstones + 1 > capacity_ - capacity_ / 8)
+			rehash(size_ + 1 > capacity_ / 2 ? 2 * capacity_ : capacity_);
+
+		return {place(h, std::forward<Args>(args)...), true};
+	}
+
+	/**
+	 * @brief Destroys the element in slot `i`
+	 */
+	void erase(std::size_t i) {
+		slot(i).~T();
+		std::size_t group = i & ~(ControlGroup::width - 1);
+		if (ControlGroup{&ctrl[group]}.match_empty()) {
+			// no probe sequence ever went past this group
+			ctrl[i] = ControlGroup::empty;
+		} else {
+			ctrl[i] = ControlGroup::deleted;
+			++tombstones;
+		}
+		--size_;
+	}
+
+	/**
+	 * @brief Returns true if slot `i` holds an element
+	 */
+	bool full(std::size_t i) const { return ctrl[i] >= 0; }
+
+	T& slot(std::size_t i) { return *reinterpret_cast<T*>(&slots[i]); }
+
+	const T& slot(std::size_t i) const {
+		return *reinterpret_cast<const T*>(&slots[i]);
+	}
+
+	void clear() {
+		FlatTable<T, KeyOf, Hash, Eq> empty;
+		swap(empty);
+	}
+
+	std::size_t size() const { return size_; }
+
+	std::size_t capacity() const { return capacity_; }
+
+	/**
+	 * @brief Approximate amount of bytes used by the table
+	 */
+	std::size_t memory_usage() const {
+		return sizeof(*this) + capacity_ * (sizeof(T) + 1);
+	}
+
+	/**
+	 * @brief Returns a list of the slots that hold an element
+	 */
+	ArrayList<T> items() const {
+		ArrayList<T> al{size_ + 1};
+		for (std::size_t i = 0; i < capacity_; i++)
+			if (full(i))
+				al.push_back(slot(i));
+		return al;
+	}
+
+private:
+	using Storage =
+		typename std::aligned_storage<sizeof(T), alignof(T)>::type;
+
+	const static std::size_t starting_size{2 * ControlGroup::width};
+
+	static std::int8_t h2(std::uint64_t h) { return h & 0x7F; }
+
+	// builds an element that is not in the table in the first free slot
+	template <typename... Args>
+	std::size_t place(std::uint64_t h, Args&&... args) {
+		std::size_t mask = capacity_ / ControlGroup::width - 1;
+		std::size_t group = (h >> 7) & mask;
+		for (std::size_t step = 1;; step++) {
+			std::size_t first = group * ControlGroup::width;
+			auto m = ControlGroup{&ctrl[first]}.match_free();
+			if (m) {
+				std::size_t i = first + ControlGroup::lowest(m);
+				if (ctrl[i] == ControlGroup::deleted)
+					--tombstones;
+				new (&slots[i]) T(std::forward<Args>(args)...);
+				ctrl[i] = h2(h);
+				++size_;
+				return i;
+			}
+			group = (group + step) & mask;
+		}
+	}
+
+	void allocate(std::size_t new_capacity) {
+		ctrl.reset(new std::int8_t[new_capacity]);
+		std::memset(ctrl.get(), ControlGroup::empty, new_capacity);
+		slots.reset(new Storage[new_capacity]);
+		capacity_ = new_capacity;
+	}
+
+	// moves the elements to a table with `new_capacity` slots
+	void rehash(std::size_t new_capacity) {
+		if (new_capacity < starting_size)
+			new_capacity = starting_size;
+
+		FlatTable<T, KeyOf, Hash, Eq> table;
+		table.allocate(new_capacity);
+		for (std::size_t i = 0; i < capacity_; i++) {
+			if (full(i)) {
+				table.place(hash(keyf(slot(i))), std::move(slot(i)));
+				slot(i).~T();
+				ctrl[i] = ControlGroup::empty;
+			}
+		}
+		size_ = 0;
+		swap(table);
+	}
+
+	void destroy_all() {
+		for (std::size_t i = 0; i < capacity_; i++)
+			if (full(i))
+				slot(i).~T();
+	}
+
+	void swap(FlatTable<T, KeyOf, Hash, Eq>& other) {
+		std::swap(ctrl, other.ctrl);
+		std::swap(slots, other.slots);
+		std::swap(capacity_, other.capacity_);
+		std::swap(size_, other.size_);
+		std::swap(tombstones, other.tombstones);
+	}
+
+	std::unique_ptr<std::int8_t[]> ctrl;
+	std::unique_ptr<Storage[]> slots;
+	std::size_t capacity_{0u};
+	std::size_t size_{0u};
+	std::size_t tombstones{0u};
+
+	KeyOf keyf{};
+	Hash hashf{};
+	Eq eq{};
+};
+
+/**
+ * @brief The key of an element of a set is the element itself
+ */
+struct Identity {
+	template <typename T>
+	const T& operator()(const T& data) const {
+		return data;
+	}
+};
+
+/**
+ * @brief Open addressing HashTable implementation
+ *
+ * @details A set on top of FlatTable: elements are stored inline, with no
+ * allocation per element, and only the elements whose 7 bits of hash match
+ * are compared with `==`.
+ *
+ * @tparam T    Data type of the elements
+ * @tparam Hash Class that implements the hash function
+ */
+template <typename T, typename Hash = std::hash<T>>
+class FlatHashTableWrapper {
+public:
+	/**
+	 * @brief Inserts `data` into the table
+	 *
+	 * @return false if `data` was already in the table, otherwise true
+	 */
+	bool insert(const T& data) { return table.emplace(data, data).second; }
+
+	/**
+	 * @brief Removes `data` from the table
+	 *
+	 * @return false if `data` was not in the table, otherwise true
+	 */
+	bool remove(const T& data) {
+		std::size_t i = table.find(data);
+		if (i == table.capacity())
+			return false;
+		table.erase(i);
+		return true;
+	}
+
+	/**
+	 * @brief Returns true if the element is in the table
+	 */
+	bool contains(const T& data) const {
+		return table.find(data) != table.capacity();
+	}
+
+	/**
+	 * @brief Sets `out[i]` to whether the table contains `keys[i]`
+	 *
+	 * @details The keys are hashed and the first group of each is
+	 * prefetched a batch at a time before any of them is searched, so the
+	 * cache misses of the batch overlap.
+	 */
+	void contains_many(const T* keys, std::size_t n, bool* out) const {
+		std::uint64_t h[batch];
+		for (std::size_t first = 0; first < n; first += batch) {
+			std::size_t count = std::min(batch, n - first);
+			for (std::size_t i = 0; i < count; i++) {
+				h[i] = table.hash(keys[first + i]);
+				table.prefetch(h[i]);
+			}
+			for (std::size_t i = 0; i < count; i++)
+				out[first + i] =
+					table.find(keys[first + i], h[i]) != table.capacity();
+		}
+	}
+
+	/**
+	 * @brief Inserts `n` keys, returns how many were not in the table yet
+	 */
+	std::size_t insert_many(const T* keys, std::size_t n) {
+		std::size_t inserted = 0;
+		std::uint64_t h[batch];
+		for (std::size_t first = 0; first < n; first += batch) {
+			std::size_t count = std::min(batch, n - first);
+			for (std::size_t i = 0; i < count; i++) {
+				h[i] = table.hash(keys[first + i]);
+				table.prefetch(h[i]);
+			}
+			for (std::size_t i = 0; i < count; i++) {
+				const T& key = keys[first + i];
+				inserted += table.emplace_hashed(h[i], key, key).second;
+			}
+		}
+		return inserted;
+	}
+
+	void clear() { table.clear(); }
+
+	std::size_t size() const { return table.size(); }
+
+	/**
+	 * @brief Approximate amount of bytes used by the table
+	 */
+	std::size_t memory_usage() const { return table.memory_usage(); }
+
+	/**
+	 * @brief Returns a list of the items that are on the table
+	 */
+	ArrayList<T> items() const { return table.items(); }
+
+private:
+	// keys hashed and prefetched at once by the batched operations
+	constexpr static std::size_t batch{16};
+
+	FlatTable<T, Identity, Hash, std::equal_to<T>> table;
+};
+
+template <typename T>
+class FlatHashTable : public FlatHashTableWrapper<T> {};
+
+}  // namespace structures
+
+/* set trait */
+template <>
+const bool traits::is_set<structures::FlatHashTable>::value = true;
+
+/* name trait */
+template <>
+const std::string traits::type<structures::FlatHashTable>::name =
+	"FlatHashTable";
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef STRUCTURES_FORK_JOIN_H
+#define STRUCTURES_FORK_JOIN_H
+
+#include <cstdint>
+#include <thread>
+#include <utility>
+
+namespace structures {
+
+namespace fork_join {
+
+/**
+ * @brief Below this amount of elements, work is not split between threads
+ */
+const std::size_t cutoff{1u << 14};
+
+/**
+ * @brief Amount of threads that parallel algorithms may use
+ *
+ * @details Defaults to the amount of hardware threads, it may be changed
+ * (e.g. for benchmarks) while no parallel algorithm is running.
+ */
+inline std::size_t& threads() {
+	static std::size_t n = std::thread::hardware_concurrency();
+	return n;
+}
+
+/**
+ * @brief How many levels of recursion may still spawn a thread
+ *
+ * @details Every level doubles the amount of threads, so the depth is the
+ * smallest one that gives at least one task for each of threads().
+ */
+inline std::size_t max_depth() {
+	std::size_t depth = 0;
+	while ((std::size_t{1} << depth) < threads())
+		++depth;
+	return depth;
+}
+
+/**
+ * @brief Runs `left` and `right`, concurrently if `parallel` is true
+ *
+ * @details `left` runs on a new thread while `right` runs on the calling
+ * one, both have finished when this function returns.
+ */
+template <typename F, typename G>
+void invoke(bool parallel, F&& left, G&& right) {
+	if (parallel) {
+		std::thread t{std::forward<F>(left)};
+		right();
+		t.join();
+	} else {
+		left();
+		right();
+	}
+}
+
+}  // namespace fork_join
+
+}  // namespace structures
+
+#endif
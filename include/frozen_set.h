@@ -0,0 +1,268 @@
+#ifndef STRUCTURES_FROZEN_SET_H
+#define STRUCTURES_FROZEN_SET_H
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+
+#include <array_list.h>
+#include <utils.h>
+
+namespace structures {
+
+/**
+ * @brief Immutable set, laid out for fast searches
+ *
+ * @details The elements are stored in a single array in Eytzinger (BFS)
+ * order: the children of the element at position `k` are at `2k` and
+ * `2k + 1`. Searches descend this implicit tree without branching on the
+ * comparisons, and since the 16 descendants four levels below `k` are
+ * contiguous, they are prefetched while the next levels are compared.
+ *
+ * It is usually built with Tree::freeze().
+ *
+ * @tparam T Data type of the elements
+ */
+template <typename T>
+class FrozenSet {
+public:
+	FrozenSet() = default;
+
+	/**
+	 * @brief Builds the set from a list in strictly increasing order
+	 */
+	explicit FrozenSet(const ArrayList<T>& sorted)
+		: data{new T[sorted.size() + 1]}, size_{sorted.size()} {
+		std::size_t i = 0;
+		for (std::size_t k = first(); k != 0; k = next(k))
+			data[k] = sorted[i++];
+	}
+
+	FrozenSet(const FrozenSet<T>& other)
+		: data{new T[other.size_ + 1]}, size_{other.size_} {
+		std::copy(other.data.get(), other.data.get() + size_ + 1, data.get());
+	}
+
+	FrozenSet(FrozenSet<T>&& other)
+		: data{std::move(other.data)}, size_{other.size_} {
+		other.size_ = 0;
+	}
+
+	FrozenSet<T>& operator=(const FrozenSet<T>& other) {
+		FrozenSet<T> copy{other};
+		std::swap(data, copy.data);
+		std::swap(size_, copy.size_);
+		return *this;
+	}
+
+	FrozenSet<T>& operator=(FrozenSet<T>&& other) {
+		FrozenSet<T> moved{std::move(other)};
+		std::swap(data, moved.data);
+		std::swap(size_, moved.size_);
+		return *this;
+	}
+
+	/**
+	 * @brief Returns the smallest element that is not less than `x`, or
+	 * nullptr if there is no such element
+	 */
+	const T* lower_bound(const T& x) const {
+		std::size_t k = 1;
+		while (k <= size_) {
+			// only descendants that are all in the array are prefetched
+			if (16 * k + 15 <= size_)
+				for (std::size_t line = 0; line < prefetch_bytes; line += 64)
+					prefetch((const char*) (data.get() + 16 * k) + line);
+			k = 2 * k + (data[k] < x);
+		}
+
+		// the answer is where the search last went to the left
+		while (k & 1)
+			k >>= 1;
+		k >>= 1;
+		return k ? &data[k] : nullptr;
+	}
+
+	/**
+	 * @brief Returns true if the set contains `x`
+	 */
+	bool contains(const T& x) const {
+		auto p = lower_bound(x);
+		return p && !(x < *p);
+	}
+
+	std::size_t size() const { return size_; }
+
+	/**
+	 * @brief Returns the elements of the set, in order
+	 */
+	ArrayList<T> items() const {
+		ArrayList<T> out{size_ + 1};
+		for (std::size_t k = first(); k != 0; k = next(k))
+			out.push_back(data[k]);
+		return out;
+	}
+
+private:
+	const static std::size_t prefetch_bytes{16 * sizeof(T)};
+
+	// first position of an in-order traversal
+	std::size_t first() const {
+		if (size_ == 0)
+			return 0;
+		std::size_t k = 1;
+		while (2 * k <= size_)
+			k = 2 * k;
+		return k;
+	}
+
+	// in-order successor of `k`, or 0 after the last position
+	std::size_t next(std::size_t k) const {
+		if (2 * k + 1 <= size_) {
+			k = 2 * k + 1;
+			while (2 * k <= size_)
+				k = 2 * k;
+			return k;
+		}
+		while (k & 1)
+			k >>= 1;
+		return k >> 1;
+	}
+
+	// position 0 is not used, so the root is at 1
+	std::unique_ptr<T[]> data = make_unique<T[]>(1);
+	std::size_t size_{0u};
+};
+
+/**
+ * @brief Immutable set, laid out as an implicit B-tree
+ *
+ * @details The elements are grouped in blocks aligned to a cache line, and
+ * the children of block `k` are the blocks `k * (B + 1) + 1` to
+ * `k * (B + 1) + B + 1`. A block of elements of up to 32 bytes is a single
+ * cache line, so a search touches one line per level, and the tree has
+ * log_(B+1) n levels, i.e. four times fewer than a binary one for 4 byte
+ * elements. The last block is padded with copies of the largest element.
+ *
+ * @tparam T Data type of the elements
+ */
+template <typename T>
+class FrozenBlockedSet {
+public:
+	FrozenBlockedSet() = default;
+
+	/**
+	 * @brief Builds the set from a list in strictly increasing order
+	 */
+	explicit FrozenBlockedSet(const ArrayList<T>& sorted)
+		: blocks{(sorted.size() + B - 1) / B}
+		, data{new Block[blocks]}
+		, size_{sorted.size()} {
+		std::size_t i = 0;
+		fill(0, sorted, i);
+	}
+
+	FrozenBlockedSet(const FrozenBlockedSet<T>& other)
+		: blocks{other.blocks}, data{new Block[blocks]}, size_{other.size_} {
+		std::copy(other.data.get(), other.data.get() + blocks, data.get());
+	}
+
+	FrozenBlockedSet(FrozenBlockedSet<T>&& other)
+		: blocks{other.blocks}
+		, data{std::move(other.data)}
+		, size_{other.size_} {
+		other.blocks = 0;
+		other.size_ = 0;
+	}
+
+	FrozenBlockedSet<T>& operator=(const FrozenBlockedSet<T>& other) {
+		FrozenBlockedSet<T> copy{other};
+		std::swap(blocks, copy.blocks);
+		std::swap(data, copy.data);
+		std::swap(size_, copy.size_);
+		return *this;
+	}
+
+	FrozenBlockedSet<T>& operator=(FrozenBlockedSet<T>&& other) {
+		FrozenBlockedSet<T> moved{std::move(other)};
+		std::swap(blocks, moved.blocks);
+		std::swap(data, moved.data);
+		std::swap(size_, moved.size_);
+		return *this;
+	}
+
+	/**
+	 * @brief Returns the smallest element that is not less than `x`, or
+	 * nullptr if there is no such element
+	 */
+	const T* lower_bound(const T& x) const {
+		const T* result = nullptr;
+		std::size_t k = 0;
+		while (k < blocks) {
+			const T* block = data[k].keys;
+			std::size_t i = 0;
+			for (std::size_t j = 0; j < B; j++)
+				i += block[j] < x;
+			if (i < B)
+				result = block + i;
+			k = k * (B + 1) + i + 1;
+		}
+		return result;
+	}
+
+	/**
+	 * @brief Returns true if the set contains `x`
+	 */
+	bool contains(const T& x) const {
+		auto p = lower_bound(x);
+		return p && !(x < *p);
+	}
+
+	std::size_t size() const { return size_; }
+
+	/**
+	 * @brief Returns the elements of the set, in order
+	 */
+	ArrayList<T> items() const {
+		ArrayList<T> out{size_ + 1};
+		collect(0, out);
+		return out;
+	}
+
+private:
+	const static std::size_t B{sizeof(T) < 32 ? 64 / sizeof(T) : 2};
+
+	// fills the blocks of the subtree rooted at `k` in order
+	void fill(std::size_t k, const ArrayList<T>& sorted, std::size_t& i) {
+		if (k >= blocks)
+			return;
+		for (std::size_t j = 0; j <= B; j++) {
+			fill(k * (B + 1) + j + 1, sorted, i);
+			if (j < B)
+				data[k].keys[j] = i < size_ ? sorted[i++] : sorted[size_ - 1];
+		}
+	}
+
+	void collect(std::size_t k, ArrayList<T>& out) const {
+		if (k >= blocks)
+			return;
+		for (std::size_t j = 0; j <= B; j++) {
+			collect(k * (B + 1) + j + 1, out);
+			if (j < B && out.size() < size_)
+				out.push_back(data[k].keys[j]);
+		}
+	}
+
+	// aligned, so that a block never straddles two cache lines
+	struct alignas(64) Block {
+		T keys[B];
+	};
+
+	std::size_t blocks{0u};
+	std::unique_ptr<Block[]> data = make_unique<Block[]>(1);
+	std::size_t size_{0u};
+};
+
+}  // namespace structures
+
+#endif
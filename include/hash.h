@@ -0,0 +1,275 @@
+#ifndef STRUCTURES_HASH_H
+#define STRUCTURES_HASH_H
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+namespace structures {
+
+/*
+ * Hash functions that can be given as the `Hash` parameter of the hash
+ * structures. They all declare `is_avalanching`: every bit of their result
+ * depends on every bit of the key, so the structures use it as it is instead
+ * of mixing it again. The string hashers are also transparent, like
+ * StringHash.
+ */
+
+namespace detail {
+
+#if defined(__SIZEOF_INT128__)
+__extension__ typedef unsigned __int128 uint128;
+#endif
+
+// the 128 bit product of `a` and `b`, in `a` (low half) and `b` (high half)
+inline void multiply(std::uint64_t& a, std::uint64_t& b) {
+#if defined(__SIZEOF_INT128__)
+	uint128 r = static_cast<uint128>(a) * b;
+	a = static_cast<std::uint64_t>(r);
+	b = static_cast<std::uint64_t>(r >> 64);
+#else
+	std::uint64_t ha = a >> 32, hb = b >> 32;
+	std::uint64_t la = a & 0xFFFFFFFFull, lb = b & 0xFFFFFFFFull;
+	std::uint64_t hh = ha * hb, hl = ha * lb, lh = la * hb, ll = la * lb;
+	std::uint64_t middle = (ll >> 32) + (hl & 0xFFFFFFFFull) + lh;
+	a = (middle << 32) | (ll & 0xFFFFFFFFull);
+	b = hh + (hl >> 32) + (middle >> 32);
+#endif
+}
+
+// the two halves of the 128 bit product, xored
+inline std::uint64_t fold(std::uint64_t a, std::uint64_t b) {
+	multiply(a, b);
+	return a ^ b;
+}
+
+inline std::uint64_t read64(const unsigned char* p) {
+	std::uint64_t v;
+	std::memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+inline std::uint64_t read32(const unsigned char* p) {
+	std::uint32_t v;
+	std::memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+}  // namespace detail
+
+/**
+ * @brief Hashes `size` bytes as wyhash does
+ *
+ * @details Each 16 bytes cost one 64x64 -> 128 bit multiplication, with three
+ * independent chains over long inputs; keys up to 16 bytes are read with at
+ * most four overlapping loads, without a loop.
+ */
+inline std::uint64_t wyhash(
+	const void* data, std::size_t size, std::uint64_t seed = 0) {
+	const std::uint64_t secret[4] = {
+		0xa0761d6478bd642full, 0xe7037ed1a0b428dbull, 0x8ebc6af09c88c6e3ull,
+		0x589965cc75374cc3ull};
+	auto p = static_cast<const unsigned char*>(data);
+	seed ^= detail::fold(seed ^ secret[0], secret[1]);
+
+	std::uint64_t a, b;
+	if (size <= 16) {
+		if (size >= 4) {
+			std::size_t middle = (size >> 3) << 2;
+			a = (detail::read32(p) << 32) | detail::read32(p + middle);
+			b = (detail::read32(p + size - 4) << 32) |
+				detail::read32(p + size - 4 - middle);
+		} else if (size > 0) {
+			a = (std::uint64_t{p[0]} << 16) |
+				(std::uint64_t{p[size >> 1]} << 8) | p[size - 1];
+			b = 0;
+		} else {
+			a = b = 0;
+		}
+	} else {
+		std::size_t i = size;
+		if (i > 48) {
+			std::uint64_t see1 = seed, see2 = seed;
+			do {
+				seed = detail::fold(
+					detail::read64(p) ^ secret[1],
+					detail::read64(p + 8) ^ seed);
+				see1 = detail::fold(
+					detail::read64(p + 16) ^ secret[2],
+					detail::read64(p + 24) ^ see1);
+				see2 = detail::fold(
+					detail::read64(p + 32) ^ secret[3],
+					detail::read64(p + 40) ^ see2);
+				p += 48;
+				i -= 48;
+			} while (i > 48);
+			seed ^= see1 ^ see2;
+		}
+		while (i > 16) {
+			seed = detail::fold(
+				detail::read64(p) ^ secret[1], detail::read64(p + 8) ^ seed);
+			p += 16;
+			i -= 16;
+		}
+		a = detail::read64(p + i - 16);
+		b = detail::read64(p + i - 8);
+	}
+
+	a ^= secret[1];
+	b ^= seed;
+	detail::multiply(a, b);
+	return detail::fold(a ^ secret[0] ^ size, b ^ secret[1]);
+}
+
+/**
+ * @brief Hashes `size` bytes as XXH3 does
+ *
+ * @details Keys up to 16 bytes take one of three branch-free paths by size,
+ * keys up to 128 bytes mix 16 byte pairs read from both ends, and longer keys
+ * are consumed 32 bytes at a time by four independent accumulators, which
+ * the compiler keeps in registers (or in one vector register). The secret is
+ * shorter than XXH3's, so the results differ from the reference.
+ */
+inline std::uint64_t xxh3(
+	const void* data, std::size_t size, std::uint64_t seed = 0) {
+	const std::uint64_t secret[8] = {
+		0xbe4ba423396cfeb8ull, 0x1cad21f72c81017cull, 0xdb979083e96dd4deull,
+		0x1f67b3b7a4a44072ull, 0x78e5c0cc4ee679cbull, 0x2172ffcc7dd05a82ull,
+		0x8e2443f7744608b8ull, 0x4c263a81e69035e0ull};
+	const std::uint64_t prime1 = 0x9E3779B185EBCA87ull;
+	const std::uint64_t prime2 = 0xC2B2AE3D27D4EB4Full;
+	auto avalanche = [](std::uint64_t h) {
+		h ^= h >> 37;
+		h *= 0x165667919E3779F9ull;
+		return h ^ (h >> 32);
+	};
+	auto mix16 = [&](const unsigned char* p, std::size_t s) {
+		return detail::fold(
+			detail::read64(p) ^ (secret[s % 8] + seed),
+			detail::read64(p + 8) ^ (secret[(s + 1) % 8] - seed));
+	};
+	auto p = static_cast<const unsigned char*>(data);
+
+	if (size == 0)
+		return avalanche(seed ^ secret[0] ^ secret[1]);
+	if (size <= 3) {
+		std::uint64_t c = (std::uint64_t{p[0]} << 16) |
+						  (std::uint64_t{p[size >> 1]} << 24) | p[size - 1] |
+						  (size << 8);
+		return avalanche(c ^ ((secret[0] ^ secret[1]) + seed));
+	}
+	if (size <= 8) {
+		std::uint64_t v =
+			detail::read32(p + size - 4) + (detail::read32(p) << 32);
+		std::uint64_t h = v ^ ((secret[2] ^ secret[3]) - seed);
+		// rrmxmx, stronger than avalanche for a single multiplication
+		h ^= ((h << 49) | (h >> 15)) ^ ((h << 24) | (h >> 40));
+		h *= 0x9FB21C651E98DF25ull;
+		h ^= (h >> 35) + size;
+		h *= 0x9FB21C651E98DF25ull;
+		return h ^ (h >> 28);
+	}
+	if (size <= 16) {
+		std::uint64_t lo = detail::read64(p) ^ ((secret[4] ^ secret[5]) + seed);
+		std::uint64_t hi =
+			detail::read64(p + size - 8) ^ ((secret[6] ^ secret[7]) - seed);
+		std::uint64_t swapped = (lo << 32) | (lo >> 32);
+		return avalanche(size + swapped + hi + detail::fold(lo, hi));
+	}
+
+	std::uint64_t acc = size * prime1;
+	if (size <= 128) {
+		for (std::size_t i = 0; 32 * i < size; i++) {
+			acc += mix16(p + 16 * i, 2 * i);
+			acc += mix16(p + size - 16 * (i + 1), 2 * i + 1);
+		}
+		return avalanche(acc);
+	}
+
+	std::uint64_t lanes[4] = {prime1, prime2, secret[0], secret[1] ^ seed};
+	std::size_t stripes = (size - 1) / 32;
+	for (std::size_t s = 0; s < stripes; s++) {
+		const unsigned char* stripe = p + 32 * s;
+		for (std::size_t j = 0; j < 4; j++) {
+			std::uint64_t v = detail::read64(stripe + 8 * j);
+			// keyed by the stripe too, so equal stripes add different values
+			std::uint64_t k = v ^ (secret[(s + j) % 8] + s * prime2);
+			lanes[j ^ 1] += v;
+			lanes[j] += (k & 0xFFFFFFFFull) * (k >> 32);
+		}
+		// scrambles the accumulators every 512 bytes
+		if (s % 16 == 15)
+			for (std::size_t j = 0; j < 4; j++)
+				lanes[j] = (lanes[j] ^ (lanes[j] >> 47) ^ secret[j]) * prime1;
+	}
+	// the last 32 bytes, which may overlap the last stripe
+	for (std::size_t j = 0; j < 4; j++) {
+		std::uint64_t v = detail::read64(p + size - 32 + 8 * j);
+		std::uint64_t k = v ^ secret[j + 4];
+		lanes[j ^ 1] += v;
+		lanes[j] += (k & 0xFFFFFFFFull) * (k >> 32);
+	}
+	acc += detail::fold(lanes[0] ^ secret[2], lanes[1] ^ secret[3]);
+	acc += detail::fold(lanes[2] ^ secret[4], lanes[3] ^ secret[5]);
+	return avalanche(acc);
+}
+
+/**
+ * @brief Hash of integers, enums and floating point numbers
+ *
+ * @details The value is mixed by the finalizer of MurmurHash3, so keys that
+ * differ in a few bits, e.g. sequential or strided integers, get unrelated
+ * hashes. Positive and negative zero hash equally.
+ */
+struct IntegerHash {
+	using is_avalanching = void;
+
+	template <
+		typename T,
+		typename = std::enable_if_t<
+			std::is_arithmetic<T>::value || std::is_enum<T>::value>>
+	std::uint64_t operator()(T x) const {
+		std::uint64_t h = 0;
+		if constexpr (std::is_floating_point<T>::value) {
+			if (x == 0)
+				x = 0;
+			std::memcpy(&h, &x, sizeof(x) < sizeof(h) ? sizeof(x) : sizeof(h));
+		} else {
+			h = static_cast<std::uint64_t>(x);
+		}
+		h ^= h >> 33;
+		h *= 0xFF51AFD7ED558CCDull;
+		h ^= h >> 33;
+		h *= 0xC4CEB9FE1A85EC53ull;
+		return h ^ (h >> 33);
+	}
+};
+
+/**
+ * @brief Hash of strings with wyhash
+ */
+struct WyHash {
+	using is_avalanching = void;
+	using is_transparent = void;
+
+	std::uint64_t operator()(std::string_view s) const {
+		return wyhash(s.data(), s.size());
+	}
+};
+
+/**
+ * @brief Hash of strings with xxh3
+ */
+struct XXH3Hash {
+	using is_avalanching = void;
+	using is_transparent = void;
+
+	std::uint64_t operator()(std::string_view s) const {
+		return xxh3(s.data(), s.size());
+	}
+};
+
+}  // namespace structures
+
+#endif
@@ -0,0 +1,167 @@
+#ifndef STRUCTURES_HASH_MAP_H
+#define STRUCTURES_HASH_MAP_H
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <array_list.h>
+#include <flat_hash_table.h>
+
+namespace structures {
+
+/**
+ * @brief Transparent hash of strings, so that a HashMap with std::string keys
+ * can be searched with a std::string_view or a C string
+ *
+ * @details It hashes like std::hash<std::string>, which the standard
+ * guarantees to agree with std::hash<std::string_view>.
+ */
+struct StringHash {
+	using is_transparent = void;
+
+	std::size_t operator()(std::string_view s) const {
+		return std::hash<std::string_view>{}(s);
+	}
+};
+
+/**
+ * @brief Open addressing hash map
+ *
+ * @details Maps each key to one value, stored together inline on a
+ * FlatTable. Lookups never build a value, and when both `Hash` and `Eq` are
+ * transparent (e.g. StringHash and std::equal_to<>) they never build a key
+ * either: any type they accept can be used to search.
+ *
+ * Pointers returned by find, operator[] and the insertion methods are
+ * invalidated by the next insertion.
+ *
+ * @tparam K    Data type of the keys
+ * @tparam V    Data type of the values
+ * @tparam Hash Class that implements the hash function of the keys
+ * @tparam Eq   Class that compares keys for equality
+ */
+template <
+	typename K, typename V, typename Hash = std::hash<K>,
+	typename Eq = std::equal_to<K>>
+class HashMap {
+	template <typename H, typename E, typename = void>
+	struct transparent : std::false_type {};
+
+	template <typename H, typename E>
+	struct transparent<
+		H, E,
+		std::void_t<typename H::is_transparent, typename E::is_transparent>>
+		: std::true_type {};
+
+public:
+	/**
+	 * @brief Returns the value of `key`, or nullptr if it is not in the map
+	 */
+	template <typename L>
+	V* find(const L& key) {
+		std::size_t i = slot_of(key);
+		return i == table.capacity() ? nullptr : &table.slot(i).second;
+	}
+
+	template <typename L>
+	const V* find(const L& key) const {
+		std::size_t i = slot_of(key);
+		return i == table.capacity() ? nullptr : &table.slot(i).second;
+	}
+
+	/**
+	 * @brief Returns true if `key` is in the map
+	 */
+	template <typename L>
+	bool contains(const L& key) const {
+		return find(key) != nullptr;
+	}
+
+	/**
+	 * @brief Returns the value of `key`, default constructing it if `key` is
+	 * not in the map
+	 */
+	V& operator[](const K& key) { return *try_emplace(key).first; }
+
+	/**
+	 * @brief Builds the value of `key` from `args` if `key` is not in the
+	 * map, otherwise does nothing (`args` are not moved from)
+	 *
+	 * @return The value of `key`, and whether it was inserted
+	 */
+	template <typename... Args>
+	std::pair<V*, bool> try_emplace(const K& key, Args&&... args) {
+		auto r = table.emplace(
+			key, std::piecewise_construct, std::forward_as_tuple(key),
+			std::forward_as_tuple(std::forward<Args>(args)...));
+		return {&table.slot(r.first).second, r.second};
+	}
+
+	/**
+	 * @brief Sets the value of `key`, inserting it if needed
+	 *
+	 * @return The value of `key`, and whether it was inserted
+	 */
+	template <typename M>
+	std::pair<V*, bool> insert_or_assign(const K& key, M&& value) {
+		auto r = try_emplace(key, std::forward<M>(value));
+		if (!r.second)
+			*r.first = std::forward<M>(value);
+		return r;
+	}
+
+	/**
+	 * @brief Removes `key` and its value from the map
+	 *
+	 * @return false if `key` was not in the map, otherwise true
+	 */
+	template <typename L>
+	bool remove(const L& key) {
+		std::size_t i = slot_of(key);
+		if (i == table.capacity())
+			return false;
+		table.erase(i);
+		return true;
+	}
+
+	void clear() { table.clear(); }
+
+	std::size_t size() const { return table.size(); }
+
+	/**
+	 * @brief Approximate amount of bytes used by the map
+	 */
+	std::size_t memory_usage() const { return table.memory_usage(); }
+
+	/**
+	 * @brief Returns a list of the (key, value) pairs that are on the map
+	 */
+	ArrayList<std::pair<K, V>> items() const { return table.items(); }
+
+private:
+	// keys are searched as they are if possible, otherwise as a K
+	template <typename L>
+	std::size_t slot_of(const L& key) const {
+		if constexpr (
+			transparent<Hash, Eq>::value || std::is_same<L, K>::value)
+			return table.find(key);
+		else
+			return table.find(K(key));
+	}
+
+	struct First {
+		const K& operator()(const std::pair<K, V>& slot) const {
+			return slot.first;
+		}
+	};
+
+	FlatTable<std::pair<K, V>, First, Hash, Eq> table;
+};
+
+}  // namespace structures
+
+#endif
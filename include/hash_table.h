@@ -1,15 +1,83 @@
 #ifndef HASH_TABLE_H
 #define HASH_TABLE_H
 
+#include <algorithm>
 #include <functional>
 
 #include <array_list.h>
 #include <linked_list.h>
+#include <perfect_hash_set.h>
 #include <traits.h>
 #include <utils.h>
 
 namespace structures {
 
+/**
+ * @brief Policy of HashTableWrapper that stores only the elements
+ *
+ * @details Their hash is computed again when the table is resized.
+ */
+struct UncachedHash {
+	template <typename T>
+	using Entry = T;
+
+	template <typename T>
+	static Entry<T> make(const T& data, std::size_t) {
+		return data;
+	}
+
+	template <typename T>
+	static const T& data(const Entry<T>& entry) {
+		return entry;
+	}
+
+	template <typename T, typename Hash>
+	static std::size_t hash(const Entry<T>& entry, const Hash& hashf) {
+		return spread_hash<Hash>(hashf(entry));
+	}
+
+	template <typename T>
+	static bool equal(const Entry<T>& entry, const T& data, std::size_t) {
+		return entry == data;
+	}
+};
+
+/**
+ * @brief Policy of HashTableWrapper that stores the hash of each element
+ * next to it
+ *
+ * @details Resizing never calls the hash function, and lookups only compare
+ * elements with `==` when their hashes are equal, which pays off when
+ * hashing or comparing elements is expensive, e.g. for strings.
+ */
+struct CachedHash {
+	template <typename T>
+	struct Entry {
+		std::size_t hash;
+		T data;
+	};
+
+	template <typename T>
+	static Entry<T> make(const T& data, std::size_t hash) {
+		return {hash, data};
+	}
+
+	template <typename T>
+	static const T& data(const Entry<T>& entry) {
+		return entry.data;
+	}
+
+	template <typename T, typename Hash>
+	static std::size_t hash(const Entry<T>& entry, const Hash&) {
+		return entry.hash;
+	}
+
+	template <typename T>
+	static bool equal(const Entry<T>& entry, const T& data, std::size_t hash) {
+		return entry.hash == hash && entry.data == data;
+	}
+};
+
 /**
  * @brief HashTable implementation
  *
@@ -18,42 +86,62 @@ namespace structures {
  * amortized constant time on average cases, and linear time in worst cases,
  * but that is unlikely to happen with a good hash function.
  *
- * This structure grows and shrinks as you insert and remove.
+ * This structure grows and shrinks as you insert and remove. Resizing is
+ * incremental: the old and the new bucket arrays are kept together, and
+ * every insertion or removal moves a bounded amount of buckets from the old
+ * array to the new one, so no single operation pays for the whole rehash.
+ * The amount of buckets is always a power of 2, so the bucket of a hash is
+ * found with a mask instead of a division.
  *
- * @tparam T Data type of the elements
- * @tparam Hash Class that implements the hash function
+ * @tparam T      Data type of the elements
+ * @tparam Hash   Class that implements the hash function
+ * @tparam Policy UncachedHash or CachedHash, whether hashes are stored
  */
-template <typename T, typename Hash = std::hash<T>>
+template <
+	typename T, typename Hash = std::hash<T>, typename Policy = UncachedHash>
 class HashTableWrapper {
+	using Entry = typename Policy::template Entry<T>;
+
 public:
 	HashTableWrapper() = default;
 
-	HashTableWrapper(const HashTableWrapper<T>& other)
+	HashTableWrapper(const HashTableWrapper<T, Hash, Policy>& other)
 		: HashTableWrapper(other.buckets_size) {
-		auto list = other.items();
-		for (std::size_t i = 0; i < list.size(); i++) {
-			insert(list[i]);
+		for (std::size_t i = 0; i < buckets_size; i++)
+			buckets[i] = other.buckets[i];
+		if (other.rehashing()) {
+			old_buckets.reset(new LinkedList<Entry>[other.old_size]);
+			for (std::size_t i = other.migrated; i < other.old_size; i++)
+				old_buckets[i] = other.old_buckets[i];
 		}
+		_size = other._size;
+		old_size = other.old_size;
+		migrated = other.migrated;
+		rehash_step = other.rehash_step;
+		pace = other.pace;
 	}
 
-	HashTableWrapper(HashTableWrapper<T>&& other)
+	HashTableWrapper(HashTableWrapper<T, Hash, Policy>&& other)
 		: buckets{std::move(other.buckets)}
 		, buckets_size{std::move(other.buckets_size)}
-		, _size{std::move(other._size)} {}
-
-	HashTableWrapper<T>& operator=(const HashTableWrapper<T>& other) {
-		HashTableWrapper<T> copy{other};
-		std::swap(buckets_size, copy.buckets_size);
-		std::swap(buckets, copy.buckets);
-		std::swap(_size, copy._size);
+		, _size{std::move(other._size)}
+		, old_buckets{std::move(other.old_buckets)}
+		, old_size{std::move(other.old_size)}
+		, migrated{std::move(other.migrated)}
+		, rehash_step{std::move(other.rehash_step)}
+		, pace{std::move(other.pace)} {}
+
+	HashTableWrapper<T, Hash, Policy>& operator=(
+		const HashTableWrapper<T, Hash, Policy>& other) {
+		HashTableWrapper<T, Hash, Policy> copy{other};
+		swap(copy);
 		return *this;
 	}
 
-	HashTableWrapper<T>& operator=(HashTableWrapper<T>&& other) {
-		HashTableWrapper<T> copy{std::move(other)};
-		std::swap(buckets_size, copy.buckets_size);
-		std::swap(buckets, copy.buckets);
-		std::swap(_size, copy._size);
+	HashTableWrapper<T, Hash, Policy>& operator=(
+		HashTableWrapper<T, Hash, Policy>&& other) {
+		HashTableWrapper<T, Hash, Policy> copy{std::move(other)};
+		swap(copy);
 		return *this;
 	}
 
@@ -67,20 +155,27 @@ public:
 	 *
 	 * @return false if `data` was already in the table, otherwise true
 	 */
-	bool insert(const T& data) {
-		auto& bucket = buckets[hash(data)];
-		if (bucket.contains(data)) {
-			return false;
-		} else {
-			bucket.push_front(data);
-			_size++;
+	bool insert(const T& data) { return insert(data, hash(data)); }
 
-			if (_size == buckets_size) {
-				resize_table(buckets_size * 2);
+	/**
+	 * @brief Inserts `n` keys, returns how many were not in the table yet
+	 *
+	 * @details The keys are hashed and their buckets prefetched a batch at
+	 * a time before they are inserted.
+	 */
+	std::size_t insert_many(const T* keys, std::size_t n) {
+		std::size_t inserted = 0;
+		std::size_t h[batch];
+		for (std::size_t first = 0; first < n; first += batch) {
+			std::size_t count = std::min(batch, n - first);
+			for (std::size_t i = 0; i < count; i++) {
+				h[i] = hash(keys[first + i]);
+				prefetch(&bucket_of(h[i]));
 			}
-
-			return true;
+			for (std::size_t i = 0; i < count; i++)
+				inserted += insert(keys[first + i], h[i]);
 		}
+		return inserted;
 	}
 
 	/**
@@ -92,9 +187,11 @@ public:
 	 * @return If `data` is not found, returns false, otherwise returns true.
 	 */
 	bool remove(const T& data) {
+		migrate(pace);
 		try {
-			auto& bucket = buckets[hash(data)];
-			auto i = bucket.find(data);
+			std::size_t h = hash(data);
+			auto& bucket = bucket_of(h);
+			auto i = bucket.find_if(matches(data, h));
 			bucket.erase(i);
 			_size--;
 
@@ -114,70 +211,273 @@ public:
 	 * @brief Returns true if the element is in the table
 	 */
 	bool contains(const T& data) const {
-		return buckets[hash(data)].contains(data);
+		std::size_t h = hash(data);
+		auto& bucket = bucket_of(h);
+		return bucket.find_if(matches(data, h)) != bucket.size();
+	}
+
+	/**
+	 * @brief Sets `out[i]` to whether the table contains `keys[i]`
+	 *
+	 * @details The keys are hashed a batch at a time, and their buckets and
+	 * then the first node of each bucket are prefetched before any of them
+	 * is searched, so the cache misses of the batch overlap.
+	 */
+	void contains_many(const T* keys, std::size_t n, bool* out) const {
+		std::size_t h[batch];
+		for (std::size_t first = 0; first < n; first += batch) {
+			std::size_t count = std::min(batch, n - first);
+			for (std::size_t i = 0; i < count; i++) {
+				h[i] = hash(keys[first + i]);
+				prefetch(&bucket_of(h[i]));
+			}
+			for (std::size_t i = 0; i < count; i++) {
+				auto& bucket = bucket_of(h[i]);
+				if (!bucket.empty())
+					prefetch(&bucket.front());
+			}
+			for (std::size_t i = 0; i < count; i++) {
+				auto& bucket = bucket_of(h[i]);
+				auto j = bucket.find_if(matches(keys[first + i], h[i]));
+				out[first + i] = j != bucket.size();
+			}
+		}
 	}
 
 	void clear() {
-		HashTableWrapper<T> ht;
+		HashTableWrapper<T, Hash, Policy> ht;
+		ht.rehash_step = rehash_step;
 		*this = std::move(ht);
 	}
 
 	std::size_t size() const { return _size; }
 
+	/**
+	 * @brief Sets how many buckets are moved per operation while resizing
+	 *
+	 * @details More are moved when the next resize is closer than the
+	 * rehash would take, as after a shrink. Zero moves all of them at once,
+	 * i.e. resizing is not incremental.
+	 */
+	void set_rehash_step(std::size_t buckets) { rehash_step = buckets; }
+
+	/**
+	 * @brief Returns true while the elements are moving to a resized array
+	 */
+	bool rehashing() const { return old_size > 0; }
+
+	/**
+	 * @brief Approximate amount of bytes used by the table
+	 *
+	 * @details Each element lives in its own list node, next to a pointer.
+	 */
+	std::size_t memory_usage() const {
+		return sizeof(*this) +
+			   (buckets_size + old_size) * sizeof(LinkedList<Entry>) +
+			   _size * (sizeof(Entry) + sizeof(void*));
+	}
+
+	/**
+	 * @brief Returns how the elements spread over the buckets: item `k` is
+	 * the amount of buckets that hold `k` elements
+	 *
+	 * @details A good hash function leaves a Poisson distribution; long
+	 * chains and many empty buckets show that keys cluster.
+	 */
+	ArrayList<std::size_t> chain_lengths() const {
+		std::size_t longest = 0;
+		for_each_bucket([&](const LinkedList<Entry>& bucket) {
+			longest = std::max(longest, bucket.size());
+		});
+		ArrayList<std::size_t> counts{longest + 1};
+		for (std::size_t k = 0; k <= longest; k++)
+			counts.push_back(0);
+		for_each_bucket(
+			[&](const LinkedList<Entry>& bucket) { counts[bucket.size()]++; });
+		return counts;
+	}
+
+	/**
+	 * @brief Returns an immutable copy of the table, in which each element is
+	 * found with a single probe
+	 */
+	PerfectHashSet<T, Hash> freeze() const {
+		return PerfectHashSet<T, Hash>{items()};
+	}
+
 	/**
 	 * @brief Returns a list of the items that are on the table
 	 */
 	ArrayList<T> items() const {
 		ArrayList<T> al{_size};
 
-		for (std::size_t i = 0; i < buckets_size; i++) {
-			for (std::size_t j = 0; j < buckets[i].size(); j++) {
-				al.push_back(buckets[i].at(j));
-			}
-		}
+		for_each_bucket([&](const LinkedList<Entry>& bucket) {
+			for (std::size_t j = 0; j < bucket.size(); j++)
+				al.push_back(Policy::data(bucket.at(j)));
+		});
 
-		return std::move(al);
+		return al;
 	}
 
 private:
 	explicit HashTableWrapper(std::size_t buckets_size_)
-		: buckets{new LinkedList<T>[buckets_size_]}
+		: buckets{new LinkedList<Entry>[buckets_size_]}
 		, buckets_size{buckets_size_} {}
 
-	std::size_t hash(const T& data) const { return hashf(data) % buckets_size; }
+	bool insert(const T& data, std::size_t h) {
+		migrate(pace);
+		auto& bucket = bucket_of(h);
+		if (bucket.find_if(matches(data, h)) != bucket.size()) {
+			return false;
+		} else {
+			bucket.push_front(Policy::make(data, h));
+			_size++;
+
+			if (_size == buckets_size) {
+				resize_table(buckets_size * 2);
+			}
+
+			return true;
+		}
+	}
+
+	std::size_t hash(const T& data) const {
+		return spread_hash<Hash>(hashf(data));
+	}
 
+	static auto matches(const T& data, std::size_t h) {
+		return [&data, h](const Entry& entry) {
+			return Policy::equal(entry, data, h);
+		};
+	}
+
+	/*
+	 * Old buckets are moved in order, so an element is still in the old array
+	 * if its old bucket has not been reached yet.
+	 */
+	const LinkedList<Entry>& bucket_of(std::size_t h) const {
+		if (rehashing() && (h & (old_size - 1)) >= migrated)
+			return old_buckets[h & (old_size - 1)];
+		return buckets[h & (buckets_size - 1)];
+	}
+
+	LinkedList<Entry>& bucket_of(std::size_t h) {
+		return const_cast<LinkedList<Entry>&>(
+			static_cast<const HashTableWrapper<T, Hash, Policy>&>(*this)
+				.bucket_of(h));
+	}
+
+	// the buckets that hold elements: the old ones not moved yet, then the new
+	template <typename F>
+	void for_each_bucket(F&& f) const {
+		for (std::size_t i = migrated; i < old_size; i++)
+			f(old_buckets[i]);
+		for (std::size_t i = 0; i < buckets_size; i++)
+			f(buckets[i]);
+	}
+
+	/*
+	 * Starts moving the elements to `new_size` buckets. A resize that is
+	 * still going on is finished first, which only happens if the rehash
+	 * step was changed meanwhile.
+	 */
 	void resize_table(std::size_t new_size) {
-		HashTableWrapper new_ht{new_size};
+		migrate(old_size);
+		old_buckets = std::move(buckets);
+		old_size = buckets_size;
+		migrated = 0;
+		buckets.reset(new LinkedList<Entry>[new_size]);
+		buckets_size = new_size;
+
+		// moves the old buckets before the next resize can start: shrinking
+		// may be a few removes away, so the rehash step alone is too slow
+		std::size_t ops = new_size - _size;
+		if (new_size / 2 >= starting_size)
+			ops = std::min(ops, _size - new_size / 4);
+		ops = std::max<std::size_t>(ops, 1);
+		pace = rehash_step == 0
+			? 0
+			: std::max(rehash_step, (old_size + ops - 1) / ops);
+		migrate(pace);
+	}
 
-		auto list = items();
-		for (std::size_t i = 0; i < list.size(); i++) {
-			new_ht.insert(list.at(i));
+	// moves up to `amount` old buckets, or all of them if `amount` is 0
+	void migrate(std::size_t amount) {
+		if (!rehashing())
+			return;
+
+		std::size_t end = amount == 0 || amount > old_size - migrated
+							  ? old_size
+							  : migrated + amount;
+		for (; migrated < end; migrated++) {
+			auto& bucket = old_buckets[migrated];
+			while (!bucket.empty()) {
+				std::size_t h = Policy::hash(bucket.front(), hashf);
+				buckets[h & (buckets_size - 1)].splice_front(bucket);
+			}
 		}
 
-		*this = std::move(new_ht);
+		if (migrated == old_size) {
+			old_buckets.reset();
+			old_size = 0;
+			migrated = 0;
+		}
+	}
+
+	void swap(HashTableWrapper<T, Hash, Policy>& other) {
+		std::swap(buckets, other.buckets);
+		std::swap(buckets_size, other.buckets_size);
+		std::swap(_size, other._size);
+		std::swap(old_buckets, other.old_buckets);
+		std::swap(old_size, other.old_size);
+		std::swap(migrated, other.migrated);
+		std::swap(rehash_step, other.rehash_step);
+		std::swap(pace, other.pace);
 	}
 
 	const static std::size_t starting_size{8};
+	const static std::size_t default_rehash_step{4};
+	// keys hashed and prefetched at once by the batched operations
+	constexpr static std::size_t batch{16};
 
-	std::unique_ptr<LinkedList<T>[]> buckets =
-		make_unique<LinkedList<T>[]>(starting_size);
+	std::unique_ptr<LinkedList<Entry>[]> buckets =
+		make_unique<LinkedList<Entry>[]>(starting_size);
 	std::size_t buckets_size{starting_size};
 	std::size_t _size{0};
 
+	std::unique_ptr<LinkedList<Entry>[]> old_buckets;
+	std::size_t old_size{0};
+	std::size_t migrated{0};
+	std::size_t rehash_step{default_rehash_step};
+	// buckets moved per operation by the current resize
+	std::size_t pace{default_rehash_step};
+
 	Hash hashf{};
 };
 
 template <typename T>
 class HashTable : public HashTableWrapper<T> {};
 
+/**
+ * @brief HashTable that stores the hash of each element
+ */
+template <typename T>
+class CachedHashTable : public HashTableWrapper<T, std::hash<T>, CachedHash> {
+};
+
 }  // namespace structures
 
 /* set trait */
 template <>
 const bool traits::is_set<structures::HashTable>::value = true;
+template <>
+const bool traits::is_set<structures::CachedHashTable>::value = true;
 
 /* name trait */
 template <>
 const std::string traits::type<structures::HashTable>::name = "HashTable";
+template <>
+const std::string traits::type<structures::CachedHashTable>::name =
+	"CachedHashTable";
 
 #endif
@@ -1,6 +1,13 @@
 #ifndef HEAP_H
 #define HEAP_H
 
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
 #include <array_list.h>
 #include <traits.h>
 
@@ -11,33 +18,102 @@ namespace structures {
  *
  * @details This structure provides constant time lookup to the larger element
  * in the structure, at the cost of logarithmic isertion and removal. The
- * implementation is based on a 'heap' structure, it is basically a binary
- * tree, that each node is larger than its children. The tree is represented
- * using an std::vector, and the children of a node in position `i` are at
- * position `2*i + 1` and `2*i + 2`. You may use another type(e.g.
- * std::greater) in the second template paramater, to get the smaller item at
- * the top.
+ * implementation is based on a 'heap' structure, a tree in which each node
+ * is larger than its children. The tree is represented using an ArrayList,
+ * and the children of a node in position `i` are at positions `Arity*i + 1`
+ * to `Arity*i + Arity`. You may use another type(e.g. std::greater) in the
+ * second template paramater, to get the smaller item at the top.
+ *
+ * With the default arity of 4 the tree is half as deep as a binary one, and
+ * the 4 children of a node of 4 or 8 byte elements share a cache line. Sifts
+ * are iterative and move a "hole" instead of swapping: the element being
+ * placed is kept aside until its position is found, and elements are moved,
+ * never copied.
  *
  * @tparam          T Data type of the elements
  * @tparam Comparator Type providing a strict weak ordering function
+ * @tparam      Arity Amount of children of each node
  */
-template <typename T, typename Comparator = std::less<T>>
+template <
+	typename T, typename Comparator = std::less<T>, std::size_t Arity = 4>
 class HeapWrapper {
+	static_assert(Arity >= 2, "a heap node needs at least two children");
+
 public:
 	HeapWrapper() = default;
 
+	/**
+	 * @brief Builds a Heap with the elements of [first, last), in linear time
+	 */
+	template <typename InputIt>
+	HeapWrapper(InputIt first, InputIt last) {
+		push_range(first, last);
+	}
+
 	/**
 	 * @brief Inserts an element into the Heap
 	 */
 	void push(const T& data) {
 		list.push_back(data);
+		sift_up(list.size() - 1);
+	}
 
-		auto i = list.size() - 1;
+	void push(T&& data) {
+		list.push_back(std::move(data));
+		sift_up(list.size() - 1);
+	}
 
-		while (i > 0 && comp(list[(i - 1) / 2], list[i])) {
-			std::swap(list[i], list[(i - 1) / 2]);
-			i = (i - 1) / 2;
-		}
+	/**
+	 * @brief Inserts the elements of [first, last) into the Heap
+	 *
+	 * @details The elements are appended, then only the nodes above them are
+	 * sifted down, from the bottom up (Floyd's method). Adding k elements to
+	 * a Heap of n takes O(k + log(n)^2), so building one from scratch is
+	 * linear, unlike k pushes.
+	 */
+	template <typename InputIt>
+	void push_range(InputIt first, InputIt last) {
+		using Category =
+			typename std::iterator_traits<InputIt>::iterator_category;
+		if constexpr (std::is_base_of<std::forward_iterator_tag,
+									  Category>::value)
+			list.reserve(list.size() + std::distance(first, last));
+		std::size_t old_size = list.size();
+		for (; first != last; ++first)
+			list.push_back(*first);
+		heapify(old_size);
+	}
+
+	/**
+	 * @brief Moves the elements of `other` into the Heap, leaving it empty
+	 *
+	 * @details Takes linear time in the size of the smaller Heap, since the
+	 * elements of the larger one are not moved.
+	 */
+	void merge(HeapWrapper& other) {
+		if (&other == this)
+			return;
+		if (other.size() > size())
+			std::swap(list, other.list);
+		std::size_t old_size = list.size();
+		list.reserve(old_size + other.size());
+		for (std::size_t i = 0; i < other.size(); i++)
+			list.push_back(std::move(other.list[i]));
+		other.clear();
+		heapify(old_size);
+	}
+
+	/**
+	 * @brief Removes up to `k` elements from the top of the Heap, writing
+	 * them to `out` in order
+	 *
+	 * @return The output iterator past the last element written
+	 */
+	template <typename OutputIt>
+	OutputIt pop_n(std::size_t k, OutputIt out) {
+		for (; k > 0 && !list.empty(); k--)
+			*out++ = pop();
+		return out;
 	}
 
 	/**
@@ -46,17 +122,36 @@ public:
 	 * @return The removed element
 	 */
 	T pop() {
-		std::swap(list[0], list[list.size() - 1]);
-		auto out = list[list.size() - 1];
-		list.pop_back();
-
-		heapify(0);
+		T out = std::move(list[0]);
+		T last = list.pop_back();
+		if (!list.empty())
+			sift_down(0, std::move(last));
+		return out;
+	}
 
+	/**
+	 * @brief Replaces the top element with `data`, with a single sift
+	 *
+	 * @details Throws std::out_of_range if the Heap is empty, like pop.
+	 *
+	 * @return The replaced element
+	 */
+	T replace_top(T data) {
+		if (list.empty())
+			throw std::out_of_range("Heap is empty");
+		T out = std::move(list[0]);
+		sift_down(0, std::move(data));
 		return out;
 	}
 
 	void clear() { list.clear(); }
 
+	/**
+	 * @brief Makes room for `capacity` elements, so that pushing up to that
+	 * many does not reallocate
+	 */
+	void reserve(std::size_t capacity) { list.reserve(capacity); }
+
 	/**
 	 * @brief const ref to the top element of the Heap
 	 */
@@ -65,27 +160,57 @@ public:
 	std::size_t size() const { return list.size(); }
 
 private:
-	void heapify(std::size_t i) {
-		auto left_node = 2 * i + 1;
-		auto right_node = 2 * i + 2;
-
-		std::size_t larger;
-
-		if (left_node < list.size() && right_node >= list.size()) {
-			larger = left_node;
-		} else if (right_node < list.size() && left_node >= list.size()) {
-			larger = right_node;
-		} else if (left_node < list.size() && right_node < list.size()) {
-			larger = comp(list[right_node], list[left_node]) ? left_node :
-															   right_node;
-		} else {
+	// restores the order after elements were appended from `old_size` on:
+	// the nodes above them are sifted down a level at a time, bottom up, so
+	// every node is sifted after its children
+	void heapify(std::size_t old_size) {
+		if (list.size() <= old_size + 1) {
+			if (old_size < list.size())
+				sift_up(old_size);
 			return;
 		}
+		std::size_t lo = old_size, hi = list.size() - 1;
+		while (hi > 0) {
+			lo = lo > 0 ? (lo - 1) / Arity : 0;
+			hi = (hi - 1) / Arity;
+			for (std::size_t i = hi + 1; i-- > lo;) {
+				T data = std::move(list[i]);
+				sift_down(i, std::move(data));
+			}
+		}
+	}
+
+	// moves the element at `i` up until its parent is not smaller
+	void sift_up(std::size_t i) {
+		T data = std::move(list[i]);
+		while (i > 0) {
+			std::size_t parent = (i - 1) / Arity;
+			if (!comp(list[parent], data))
+				break;
+			list[i] = std::move(list[parent]);
+			i = parent;
+		}
+		list[i] = std::move(data);
+	}
 
-		if (comp(list[i], list[larger])) {
-			std::swap(list[i], list[larger]);
-			heapify(larger);
+	// places `data` in the hole at `i`, or below it
+	void sift_down(std::size_t i, T&& data) {
+		const std::size_t size = list.size();
+		while (true) {
+			std::size_t first = Arity * i + 1;
+			if (first >= size)
+				break;
+			std::size_t last = first + Arity < size ? first + Arity : size;
+			std::size_t larger = first;
+			for (std::size_t c = first + 1; c < last; c++)
+				if (comp(list[larger], list[c]))
+					larger = c;
+			if (!comp(data, list[larger]))
+				break;
+			list[i] = std::move(list[larger]);
+			i = larger;
 		}
+		list[i] = std::move(data);
 	}
 
 	ArrayList<T> list;
@@ -93,7 +218,10 @@ private:
 };
 
 template <typename T>
-class Heap : public HeapWrapper<T> {};
+class Heap : public HeapWrapper<T> {
+public:
+	using HeapWrapper<T>::HeapWrapper;
+};
 
 }  // namespace structures
 
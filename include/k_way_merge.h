@@ -0,0 +1,173 @@
+#ifndef STRUCTURES_K_WAY_MERGE_H
+#define STRUCTURES_K_WAY_MERGE_H
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+
+#include <array_list.h>
+#include <traits.h>
+
+namespace structures {
+
+/**
+ * @brief Merges any amount of sorted sequences into one sorted sequence
+ *
+ * @details The sources are ArrayLists, ranges of iterators, or functions
+ * that produce the next element of a stream. Their current elements meet in
+ * a loser tree: every inner node keeps the source that lost the match
+ * played there, and the winner of the whole tree is the source of the next
+ * element. Once that element is taken, only the matches on the path from
+ * its source to the root are played again, against the losers stored
+ * there. This takes log(k) comparisons per element, about half of what a
+ * Heap of the k sources needs, and never moves elements.
+ *
+ * Equal elements come out in the order of their sources.
+ *
+ * @tparam          T Data type of the elements
+ * @tparam Comparator Type providing a strict weak ordering function
+ */
+template <typename T, typename Comparator = std::less<T>>
+class KWayMergeWrapper {
+public:
+	/**
+	 * @brief A function that writes the next element of a source to its
+	 * argument, and returns false when there are no more
+	 */
+	using Source = std::function<bool(T&)>;
+
+	/**
+	 * @brief Adds a sorted source to the merge
+	 */
+	void add(Source next) {
+		sources.push_back(std::move(next));
+		heads.push_back(T{});
+		exhausted.push_back(!sources.back()(heads.back()));
+		built = false;
+	}
+
+	template <typename InputIt>
+	void add(InputIt first, InputIt last) {
+		add([first, last](T& out) mutable {
+			if (first == last)
+				return false;
+			out = *first;
+			++first;
+			return true;
+		});
+	}
+
+	/**
+	 * @brief Adds a sorted ArrayList, which must outlive the merge
+	 */
+	void add(const ArrayList<T>& list) {
+		std::size_t i = 0;
+		add([&list, i](T& out) mutable {
+			if (i == list.size())
+				return false;
+			out = list[i++];
+			return true;
+		});
+	}
+
+	/**
+	 * @brief Takes the next element of the merged sequence into `out`
+	 *
+	 * @return false if every source is exhausted, otherwise true
+	 */
+	bool next(T& out) {
+		if (!built)
+			build();
+		if (sources.empty())
+			return false;
+		std::size_t winner = tree[0];
+		if (exhausted[winner])
+			return false;
+
+		out = std::move(heads[winner]);
+		exhausted[winner] = !sources[winner](heads[winner]);
+		replay(winner);
+		return true;
+	}
+
+	/**
+	 * @brief Writes the whole merged sequence to `out`
+	 *
+	 * @return The output iterator past the last element written
+	 */
+	template <typename OutputIt>
+	OutputIt merge(OutputIt out) {
+		T data;
+		while (next(data))
+			*out++ = std::move(data);
+		return out;
+	}
+
+	/**
+	 * @brief Amount of sources added
+	 */
+	std::size_t size() const { return sources.size(); }
+
+private:
+	// whether source `a` wins against source `b`
+	bool beats(std::size_t a, std::size_t b) const {
+		if (exhausted[a] || exhausted[b])
+			return !exhausted[a];
+		if (comp(heads[a], heads[b]))
+			return true;
+		return !comp(heads[b], heads[a]) && a < b;
+	}
+
+	// plays every match: the sources are the leaves k to 2k - 1 of an
+	// implicit binary tree, and inner node n keeps the loser at n
+	void build() {
+		const std::size_t k = sources.size();
+		tree = ArrayList<std::size_t>{k + 1};
+		for (std::size_t i = 0; i < k; i++)
+			tree.push_back(0);
+		if (k > 0)
+			tree[0] = play(1);
+		built = true;
+	}
+
+	// the winner below node `n`, storing the losers
+	std::size_t play(std::size_t n) {
+		const std::size_t k = sources.size();
+		if (n >= k)
+			return n - k;
+		std::size_t left = play(2 * n), right = play(2 * n + 1);
+		if (beats(left, right)) {
+			tree[n] = right;
+			return left;
+		}
+		tree[n] = left;
+		return right;
+	}
+
+	// plays the matches from the leaf of `source` up to the root
+	void replay(std::size_t source) {
+		std::size_t winner = source;
+		for (std::size_t n = (source + sources.size()) / 2; n > 0; n /= 2)
+			if (beats(tree[n], winner))
+				std::swap(tree[n], winner);
+		tree[0] = winner;
+	}
+
+	ArrayList<Source> sources;
+	ArrayList<T> heads;
+	ArrayList<bool> exhausted;
+	ArrayList<std::size_t> tree;
+	bool built{false};
+	Comparator comp;
+};
+
+template <typename T>
+class KWayMerge : public KWayMergeWrapper<T> {};
+
+}  // namespace structures
+
+/* name trait */
+template <>
+const std::string traits::type<structures::KWayMerge>::name = "KWayMerge";
+
+#endif
@@ -0,0 +1,106 @@
+#ifndef STRUCTURES_KEY_VALUE_HEAP_H
+#define STRUCTURES_KEY_VALUE_HEAP_H
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+
+#include <array_list.h>
+#include <heap.h>
+
+namespace structures {
+
+/**
+ * @brief A Heap of keys with large values, which moves only the keys
+ *
+ * @details The values are stored in a slab, an ArrayList whose free slots
+ * are reused, and they stay in their slot until popped. The heap itself is a
+ * HeapWrapper of small entries, a key and the slot of its value, so a sift
+ * moves 16 bytes per level whatever the size of the values, and each value
+ * is moved once when pushed and once when popped.
+ *
+ * It has the push, pop and size of HeapWrapper with `value_type` elements,
+ * and the top is read with top_key and top_value.
+ *
+ * @tparam        Key Data type of the priorities
+ * @tparam      Value Data type of the values
+ * @tparam Comparator Type providing a strict weak ordering function on keys
+ * @tparam      Arity Amount of children of each node
+ */
+template <
+	typename Key, typename Value, typename Comparator = std::less<Key>,
+	std::size_t Arity = 4>
+class KeyValueHeap {
+public:
+	using value_type = std::pair<Key, Value>;
+
+	/**
+	 * @brief Inserts `value` with priority `key`
+	 */
+	void push(Key key, Value value) {
+		std::size_t slot;
+		if (free_slots.empty()) {
+			slot = values.size();
+			values.push_back(std::move(value));
+		} else {
+			slot = free_slots.pop_back();
+			values[slot] = std::move(value);
+		}
+		heap.push(Entry{std::move(key), slot});
+	}
+
+	void push(value_type data) {
+		push(std::move(data.first), std::move(data.second));
+	}
+
+	/**
+	 * @brief Removes the top, i.e. the larger, element of the heap
+	 *
+	 * @return The key and the value of the removed element
+	 */
+	value_type pop() {
+		Entry top = heap.pop();
+		free_slots.push_back(top.slot);
+		return {std::move(top.key), std::move(values[top.slot])};
+	}
+
+	/**
+	 * @brief const ref to the key of the top element of the heap
+	 */
+	const Key& top_key() const { return heap.top().key; }
+
+	/**
+	 * @brief const ref to the value of the top element of the heap
+	 */
+	const Value& top_value() const { return values[heap.top().slot]; }
+
+	void clear() {
+		heap.clear();
+		values.clear();
+		free_slots.clear();
+	}
+
+	std::size_t size() const { return heap.size(); }
+
+private:
+	struct Entry {
+		Key key;
+		std::size_t slot;
+	};
+
+	struct ByKey {
+		bool operator()(const Entry& a, const Entry& b) const {
+			return comp(a.key, b.key);
+		}
+
+		Comparator comp;
+	};
+
+	HeapWrapper<Entry, ByKey, Arity> heap;
+	ArrayList<Value> values;
+	ArrayList<std::size_t> free_slots;
+};
+
+}  // namespace structures
+
+#endif
@@ -187,6 +187,24 @@ public:
 		}
 	}
 
+	/**
+	 * @brief Moves the first node of 'other' to the beginning of the list
+	 *
+	 * @details The element is neither copied nor reallocated.
+	 *
+	 * @param other The list that'll lose its first element
+	 */
+	void splice_front(LinkedList<T>& other) {
+		if (other.empty())
+			throw std::out_of_range("List is empty");
+		Node* moved = other.head;
+		other.head = moved->next;
+		--other.size_;
+		moved->next = head;
+		head = moved;
+		++size_;
+	}
+
 	/**
 	 * @brief Removes 'data' from the list
 	 *
@@ -245,6 +263,25 @@ public:
 		return index;
 	}
 
+	/**
+	 * @brief Returns the position of the first element that satisfies 'pred'
+	 *
+	 * @param pred The predicate that'll be called on the elements
+	 *
+	 * @return The index of the element on the list, or the size of the list
+	 * if there is none
+	 */
+	template <typename Pred>
+	std::size_t find_if(Pred pred) const {
+		std::size_t index = 0;
+		for (Node* it = head; it != nullptr; it = it->next) {
+			if (pred(it->data))
+				break;
+			++index;
+		}
+		return index;
+	}
+
 	/**
 	 * @brief Size of the list
 	 *
@@ -282,6 +319,9 @@ private:
 	};
 
 	static Node* copy_list(const Node* other_head) {
+		if (other_head == nullptr)
+			return nullptr;
+
 		auto new_tail = new Node(other_head->data);
 		auto new_head = new_tail;
 		auto it = other_head->next;
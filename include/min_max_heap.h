@@ -0,0 +1,195 @@
+#ifndef STRUCTURES_MIN_MAX_HEAP_H
+#define STRUCTURES_MIN_MAX_HEAP_H
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+
+#include <array_list.h>
+#include <traits.h>
+
+namespace structures {
+
+/**
+ * @brief A double-ended priority queue, with both the smaller and the larger
+ * element at hand
+ *
+ * @details A binary tree in an ArrayList, like a binary Heap, whose levels
+ * alternate: a node on an even level (the root is on level 0) is not larger
+ * than any of its descendants, and a node on an odd level is not smaller
+ * than any of them. The smaller element is then the root, and the larger one
+ * a child of it, so min and max take constant time, while push, pop_min and
+ * pop_max take logarithmic time.
+ *
+ * With a capacity, the heap keeps the `capacity` larger elements pushed into
+ * it: once full, a push replaces the smaller element if the new one is
+ * larger, and is rejected otherwise.
+ *
+ * @tparam          T Data type of the elements
+ * @tparam Comparator Type providing a strict weak ordering function
+ */
+template <typename T, typename Comparator = std::less<T>>
+class MinMaxHeapWrapper {
+public:
+	MinMaxHeapWrapper() = default;
+
+	/**
+	 * @brief A heap that keeps at most `capacity` elements, or any amount if
+	 * it is 0
+	 */
+	explicit MinMaxHeapWrapper(std::size_t capacity) : capacity_{capacity} {
+		list.reserve(capacity);
+	}
+
+	/**
+	 * @brief Inserts an element into the heap
+	 *
+	 * @return false if the heap was full and `data` was not larger than its
+	 * smaller element, so it was not inserted, otherwise true
+	 */
+	bool push(const T& data) { return push(T(data)); }
+
+	bool push(T&& data) {
+		if (capacity_ > 0 && list.size() == capacity_) {
+			if (!comp(list[0], data))
+				return false;
+			list[0] = std::move(data);
+			trickle_down(0);
+			return true;
+		}
+		list.push_back(std::move(data));
+		bubble_up(list.size() - 1);
+		return true;
+	}
+
+	/**
+	 * @brief Removes the smaller element of the heap
+	 *
+	 * @return The removed element
+	 */
+	T pop_min() { return erase(0); }
+
+	/**
+	 * @brief Removes the larger element of the heap
+	 *
+	 * @return The removed element
+	 */
+	T pop_max() { return erase(max_index()); }
+
+	/**
+	 * @brief const ref to the smaller element of the heap
+	 */
+	const T& min() const { return list[0]; }
+
+	/**
+	 * @brief const ref to the larger element of the heap
+	 */
+	const T& max() const { return list[max_index()]; }
+
+	void clear() { list.clear(); }
+
+	std::size_t size() const { return list.size(); }
+
+	/**
+	 * @brief The most elements the heap keeps, or 0 if it is unbounded
+	 */
+	std::size_t capacity() const { return capacity_; }
+
+private:
+	static std::size_t parent(std::size_t i) { return (i - 1) / 2; }
+
+	static bool min_level(std::size_t i) {
+		std::size_t level = 0;
+		for (++i; i > 1; i >>= 1)
+			level++;
+		return level % 2 == 0;
+	}
+
+	// whether `a` belongs above `b` on a min level, or on a max one
+	bool before(const T& a, const T& b, bool min) const {
+		return min ? comp(a, b) : comp(b, a);
+	}
+
+	std::size_t max_index() const {
+		if (list.size() < 3)
+			return list.size() == 2 ? 1 : 0;
+		return comp(list[1], list[2]) ? 2 : 1;
+	}
+
+	T erase(std::size_t i) {
+		T out = std::move(list[i]);
+		T last = list.pop_back();
+		if (i < list.size()) {
+			list[i] = std::move(last);
+			trickle_down(i);
+		}
+		return out;
+	}
+
+	// moves the element at `i` up, along the min or the max levels
+	void bubble_up(std::size_t i) {
+		if (i == 0)
+			return;
+		bool min = min_level(i);
+		std::size_t p = parent(i);
+		if (before(list[p], list[i], min)) {
+			// it belongs to the levels of the other kind
+			std::swap(list[i], list[p]);
+			i = p;
+			min = !min;
+		}
+		while (i > 2) {
+			std::size_t grandparent = parent(parent(i));
+			if (!before(list[i], list[grandparent], min))
+				break;
+			std::swap(list[i], list[grandparent]);
+			i = grandparent;
+		}
+	}
+
+	// moves the element at `i` down, to its place below
+	void trickle_down(std::size_t i) {
+		const std::size_t size = list.size();
+		const bool min = min_level(i);
+		while (2 * i + 1 < size) {
+			// the first among the children and grandchildren
+			std::size_t m = 2 * i + 1;
+			if (m + 1 < size && before(list[m + 1], list[m], min))
+				m = m + 1;
+			bool grandchild = false;
+			for (std::size_t g = 4 * i + 3; g < 4 * i + 7 && g < size; g++) {
+				if (before(list[g], list[m], min)) {
+					m = g;
+					grandchild = true;
+				}
+			}
+
+			if (!before(list[m], list[i], min))
+				break;
+			std::swap(list[m], list[i]);
+			if (!grandchild)
+				break;
+			if (before(list[parent(m)], list[m], min))
+				std::swap(list[m], list[parent(m)]);
+			i = m;
+		}
+	}
+
+	ArrayList<T> list;
+	std::size_t capacity_{0u};
+	Comparator comp;
+};
+
+template <typename T>
+class MinMaxHeap : public MinMaxHeapWrapper<T> {
+public:
+	using MinMaxHeapWrapper<T>::MinMaxHeapWrapper;
+};
+
+}  // namespace structures
+
+/* name trait */
+template <>
+const std::string traits::type<structures::MinMaxHeap>::name = "MinMaxHeap";
+
+#endif
@@ -0,0 +1,372 @@
+#ifndef STRUCTURES_PERFECT_HASH_SET_H
+#define STRUCTURES_PERFECT_HASH_SET_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+
+#include <array_list.h>
+#include <fork_join.h>
+#include <utils.h>
+
+namespace structures {
+
+/**
+ * @brief Immutable set indexed by a minimal perfect hash function
+ *
+ * @details The elements are stored in one array, each at the position given
+ * by a perfect hash function, so `contains` computes that position and
+ * compares a single element. The function is built as in PTHash: the keys
+ * are split in buckets of about 4 keys, and each bucket gets a 16 bit pilot
+ * such that hashing its keys together with the pilot sends them to free
+ * positions. Buckets are placed from the largest to the smallest. Positions
+ * are drawn from 1% more slots than keys, which makes the search fast, and
+ * the few keys that land past the end are remapped to the holes left below
+ * it, so the function is minimal.
+ *
+ * The keys are first split in partitions of a few thousand keys, each with
+ * its own function and its own part of the arrays, so partitions are built
+ * concurrently and their arrays fit in the cache while they are built.
+ *
+ * It is usually built with HashTable::freeze().
+ *
+ * @tparam T    Data type of the elements
+ * @tparam Hash Class that implements the hash function
+ */
+template <typename T, typename Hash = std::hash<T>>
+class PerfectHashSet {
+public:
+	PerfectHashSet() = default;
+
+	/**
+	 * @brief Builds the set from a list of distinct elements
+	 */
+	explicit PerfectHashSet(const ArrayList<T>& items) : size_{items.size()} {
+		if (size_ == 0)
+			return;
+
+		std::unique_ptr<std::uint64_t[]> hashes{new std::uint64_t[size_]};
+		for (std::size_t i = 0; i < size_; i++)
+			hashes[i] = hash(items[i]);
+
+		// counting sort of the keys by partition
+		parts_size = (size_ + partition_size - 1) / partition_size;
+		parts.reset(new Partition[parts_size]);
+		for (std::size_t i = 0; i < size_; i++)
+			parts[partition(hashes[i])].size++;
+		std::size_t offset = 0;
+		for (std::size_t p = 0; p < parts_size; p++) {
+			Partition& part = parts[p];
+			part.offset = offset;
+			part.slots = part.size + part.size / 100 + 1;
+			part.buckets = std::max<std::size_t>(1, part.size / bucket_size);
+			part.pilots_offset = pilots_size;
+			part.remap_offset = remap_size;
+			offset += part.size;
+			pilots_size += part.buckets;
+			remap_size += part.slots - part.size;
+		}
+
+		std::unique_ptr<std::size_t[]> order{new std::size_t[size_]};
+		std::unique_ptr<std::size_t[]> filled{new std::size_t[parts_size]};
+		for (std::size_t p = 0; p < parts_size; p++)
+			filled[p] = parts[p].offset;
+		for (std::size_t i = 0; i < size_; i++)
+			order[filled[partition(hashes[i])]++] = i;
+
+		keys.reset(new T[size_]);
+		pilots.reset(new std::uint16_t[pilots_size]);
+		// slots past the end that no key uses may still be looked up
+		remap.reset(new std::uint32_t[remap_size]);
+		std::fill(remap.get(), remap.get() + remap_size, 0);
+
+		Build build{items, hashes.get(), order.get(), {false}, {false}};
+		build_partitions(build, 0, parts_size, fork_join::max_depth());
+		if (build.collision)
+			throw std::invalid_argument("Distinct elements with equal hashes");
+		if (build.failed)
+			throw std::invalid_argument("No perfect hash function was found");
+	}
+
+	PerfectHashSet(const PerfectHashSet<T, Hash>& other)
+		: size_{other.size_}
+		, parts_size{other.parts_size}
+		, pilots_size{other.pilots_size}
+		, remap_size{other.remap_size}
+		, parts{copy_array(other.parts, parts_size)}
+		, keys{copy_array(other.keys, size_)}
+		, pilots{copy_array(other.pilots, pilots_size)}
+		, remap{copy_array(other.remap, remap_size)} {}
+
+	PerfectHashSet(PerfectHashSet<T, Hash>&& other)
+		: size_{other.size_}
+		, parts_size{other.parts_size}
+		, pilots_size{other.pilots_size}
+		, remap_size{other.remap_size}
+		, parts{std::move(other.parts)}
+		, keys{std::move(other.keys)}
+		, pilots{std::move(other.pilots)}
+		, remap{std::move(other.remap)} {
+		other.size_ = 0;
+		other.parts_size = 0;
+		other.pilots_size = 0;
+		other.remap_size = 0;
+	}
+
+	PerfectHashSet<T, Hash>& operator=(const PerfectHashSet<T, Hash>& other) {
+		PerfectHashSet<T, Hash> copy{other};
+		swap(copy);
+		return *this;
+	}
+
+	PerfectHashSet<T, Hash>& operator=(PerfectHashSet<T, Hash>&& other) {
+		PerfectHashSet<T, Hash> copy{std::move(other)};
+		swap(copy);
+		return *this;
+	}
+
+	/**
+	 * @brief Returns true if the set contains `x`
+	 */
+	bool contains(const T& x) const {
+		if (size_ == 0)
+			return false;
+		std::uint64_t h = hash(x);
+		const Partition& part = parts[partition(h)];
+		return part.size > 0 && keys[part.offset + position(part, h)] == x;
+	}
+
+	std::size_t size() const { return size_; }
+
+	/**
+	 * @brief Bytes used by the elements and the hash function, per element
+	 */
+	double bytes_per_key() const {
+		if (size_ == 0)
+			return 0;
+		std::size_t bytes = sizeof(*this) + size_ * sizeof(T) +
+							parts_size * sizeof(Partition) +
+							pilots_size * sizeof(std::uint16_t) +
+							remap_size * sizeof(std::uint32_t);
+		return static_cast<double>(bytes) / size_;
+	}
+
+	/**
+	 * @brief Returns the elements of the set, in no particular order
+	 */
+	ArrayList<T> items() const {
+		ArrayList<T> out{size_ + 1};
+		for (std::size_t i = 0; i < size_; i++)
+			out.push_back(keys[i]);
+		return out;
+	}
+
+private:
+	struct Partition {
+		std::size_t offset{0u};  // of its keys
+		std::size_t size{0u};
+		std::size_t slots{0u};  // positions drawn by the hash function
+		std::size_t buckets{0u};
+		std::size_t pilots_offset{0u};
+		std::size_t remap_offset{0u};
+		std::uint64_t seed{0u};
+	};
+
+	// the input of the construction, shared by the threads
+	struct Build {
+		const ArrayList<T>& items;
+		const std::uint64_t* hashes;
+		const std::size_t* order;  // key indexes, grouped by partition
+		std::atomic<bool> collision;
+		std::atomic<bool> failed;  // every seed was tried
+	};
+
+	enum Result { Built, Retry, Collision };
+
+	template <typename U>
+	static std::unique_ptr<U[]> copy_array(
+		const std::unique_ptr<U[]>& array, std::size_t size) {
+		std::unique_ptr<U[]> out{new U[size]};
+		std::copy(array.get(), array.get() + size, out.get());
+		return out;
+	}
+
+	const static std::size_t partition_size{4096};
+	const static std::size_t bucket_size{4};
+	const static std::size_t max_pilot{1u << 16};
+	const static std::size_t max_seed{64};
+
+	std::uint64_t hash(const T& x) const {
+		return spread_hash<Hash>(hashf(x));
+	}
+
+	// maps 32 bits of `h` uniformly to [0, n)
+	static std::size_t reduce(std::uint64_t h, std::size_t n) {
+		return static_cast<std::size_t>(((h & 0xFFFFFFFFull) * n) >> 32);
+	}
+
+	std::size_t partition(std::uint64_t h) const {
+		return reduce(h >> 32, parts_size);
+	}
+
+	// the first seed uses the hash as it is, the others remix it, so that
+	// a retry also changes the bucket sizes
+	static std::size_t bucket(const Partition& part, std::uint64_t h) {
+		return reduce(part.seed ? mix_hash(h ^ part.seed) : h, part.buckets);
+	}
+
+	static std::size_t slot(
+		const Partition& part, std::uint64_t h, std::uint64_t pilot) {
+		std::uint64_t x = mix_hash(h ^ mix_hash(pilot + (part.seed << 16)));
+		return reduce(x, part.slots);
+	}
+
+	std::size_t position(const Partition& part, std::uint64_t h) const {
+		std::uint64_t pilot = pilots[part.pilots_offset + bucket(part, h)];
+		std::size_t s = slot(part, h, pilot);
+		return s < part.size ? s : remap[part.remap_offset + s - part.size];
+	}
+
+	void build_partitions(
+		Build& build, std::size_t first, std::size_t last,
+		std::size_t depth) {
+		if (last - first > 1 && depth > 0 &&
+			(last - first) * partition_size > fork_join::cutoff) {
+			std::size_t middle = first + (last - first) / 2;
+			fork_join::invoke(
+				true,
+				[&] { build_partitions(build, first, middle, depth - 1); },
+				[&] { build_partitions(build, middle, last, depth - 1); });
+		} else {
+			for (std::size_t p = first; p < last; p++) {
+				Result r;
+				while ((r = build_partition(build, parts[p])) == Retry &&
+					   parts[p].seed < max_seed)
+					parts[p].seed++;
+				if (r == Collision)
+					build.collision = true;
+				if (r == Retry)
+					build.failed = true;
+			}
+		}
+	}
+
+	/*
+	 * Finds the pilots of a partition. If a bucket is too large or has no
+	 * pilot that works, the partition must be built again with another
+	 * seed, unless two keys have the same hash, since no seed separates
+	 * them.
+	 */
+	Result build_partition(const Build& build, Partition& part) {
+		const std::size_t n = part.size;
+		const std::size_t* order = build.order + part.offset;
+		if (n == 0)
+			return Built;
+
+		// counting sort of the keys by bucket, then of the buckets by size
+		std::unique_ptr<std::size_t[]> start{new std::size_t[part.buckets + 1]};
+		std::fill(start.get(), start.get() + part.buckets + 1, 0);
+		for (std::size_t i = 0; i < n; i++)
+			start[bucket(part, build.hashes[order[i]]) + 1]++;
+		for (std::size_t b = 0; b < part.buckets; b++)
+			start[b + 1] += start[b];
+
+		std::unique_ptr<std::uint64_t[]> by_bucket{new std::uint64_t[n]};
+		std::unique_ptr<std::size_t[]> filled{new std::size_t[part.buckets]};
+		std::copy(start.get(), start.get() + part.buckets, filled.get());
+		for (std::size_t i = 0; i < n; i++) {
+			std::uint64_t h = build.hashes[order[i]];
+			by_bucket[filled[bucket(part, h)]++] = h;
+		}
+
+		std::unique_ptr<std::size_t[]> buckets{new std::size_t[part.buckets]};
+		for (std::size_t b = 0; b < part.buckets; b++)
+			buckets[b] = b;
+		std::stable_sort(
+			buckets.get(), buckets.get() + part.buckets,
+			[&](std::size_t a, std::size_t b) {
+				return start[a + 1] - start[a] > start[b + 1] - start[b];
+			});
+
+		std::unique_ptr<bool[]> taken{new bool[part.slots]};
+		std::fill(taken.get(), taken.get() + part.slots, false);
+		std::size_t placed[64];
+		for (std::size_t i = 0; i < part.buckets; i++) {
+			std::size_t b = buckets[i];
+			std::size_t count = start[b + 1] - start[b];
+			if (count > 64)
+				return Retry;
+			for (std::size_t k = 1; k < count; k++)
+				for (std::size_t j = 0; j < k; j++)
+					if (by_bucket[start[b] + j] == by_bucket[start[b] + k])
+						return Collision;
+
+			std::uint64_t pilot = 0;
+			for (; pilot < max_pilot; pilot++) {
+				std::size_t k = 0;
+				for (; k < count; k++) {
+					std::size_t s = slot(part, by_bucket[start[b] + k], pilot);
+					if (taken[s])
+						break;
+					taken[s] = true;
+					placed[k] = s;
+				}
+				if (k == count)
+					break;
+				// also catches two keys of the bucket in the same slot
+				while (k > 0)
+					taken[placed[--k]] = false;
+			}
+			if (pilot == max_pilot)
+				return Retry;
+			pilots[part.pilots_offset + b] = static_cast<std::uint16_t>(pilot);
+		}
+
+		// slots past the end are remapped to the holes below it
+		std::size_t hole = 0;
+		for (std::size_t s = n; s < part.slots; s++) {
+			if (taken[s]) {
+				while (taken[hole])
+					hole++;
+				remap[part.remap_offset + s - n] =
+					static_cast<std::uint32_t>(hole++);
+			}
+		}
+
+		for (std::size_t i = 0; i < n; i++) {
+			std::size_t index = order[i];
+			keys[part.offset + position(part, build.hashes[index])] =
+				build.items[index];
+		}
+		return Built;
+	}
+
+	void swap(PerfectHashSet<T, Hash>& other) {
+		std::swap(size_, other.size_);
+		std::swap(parts_size, other.parts_size);
+		std::swap(pilots_size, other.pilots_size);
+		std::swap(remap_size, other.remap_size);
+		std::swap(parts, other.parts);
+		std::swap(keys, other.keys);
+		std::swap(pilots, other.pilots);
+		std::swap(remap, other.remap);
+	}
+
+	std::size_t size_{0u};
+	std::size_t parts_size{0u};
+	std::size_t pilots_size{0u};
+	std::size_t remap_size{0u};
+	std::unique_ptr<Partition[]> parts;
+	std::unique_ptr<T[]> keys;
+	std::unique_ptr<std::uint16_t[]> pilots;
+	std::unique_ptr<std::uint32_t[]> remap;
+
+	Hash hashf{};
+};
+
+}  // namespace structures
+
+#endif
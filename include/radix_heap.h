@@ -0,0 +1,147 @@
+#ifndef STRUCTURES_RADIX_HEAP_H
+#define STRUCTURES_RADIX_HEAP_H
+
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include <array_list.h>
+
+namespace structures {
+
+/**
+ * @brief A min priority queue for integer keys that never go below the
+ * last key popped, e.g. times in a simulation or distances in Dijkstra
+ *
+ * @details Elements are kept in one bucket for each bit of the key, plus one
+ * for the keys equal to the last popped key: an element goes to the bucket
+ * of the highest bit in which its key differs from the last popped key. A
+ * pop takes from the bucket of equal keys, and when that one is empty, finds
+ * the smallest key of the first bucket that is not, makes it the last key
+ * and spreads that bucket over the lower ones. Each element moves down at
+ * most once per bit, so push and pop take amortized O(log C), where C is
+ * the largest difference between two keys in the queue, and no keys are
+ * compared.
+ *
+ * It has the push, pop, top and size of HeapWrapper, with `value_type`
+ * elements, except that the smaller key is on top. Pushing a key smaller
+ * than the last one returned by top or pop throws std::invalid_argument.
+ *
+ * @tparam   Key Integer type of the priorities
+ * @tparam Value Data type of the values
+ */
+template <typename Key, typename Value>
+class RadixHeap {
+	static_assert(std::is_integral<Key>::value, "keys must be integers");
+
+public:
+	using value_type = std::pair<Key, Value>;
+
+	/**
+	 * @brief Inserts `value` with priority `key`
+	 */
+	void push(Key key, Value value) {
+		push(value_type{key, std::move(value)});
+	}
+
+	void push(value_type data) {
+		Bits bits = to_bits(data.first);
+		if (bits < last)
+			throw std::invalid_argument("Key below the last popped key");
+		buckets[bucket(bits)].push_back(std::move(data));
+		size_++;
+	}
+
+	/**
+	 * @brief Removes the element with the smaller key
+	 *
+	 * @return The removed element
+	 */
+	value_type pop() {
+		refill();
+		size_--;
+		return buckets[0].pop_back();
+	}
+
+	/**
+	 * @brief const ref to the element with the smaller key
+	 *
+	 * @details Not const, since it may have to spread a bucket to find it.
+	 */
+	const value_type& top() {
+		refill();
+		return buckets[0].back();
+	}
+
+	void clear() {
+		for (auto& b : buckets)
+			b.clear();
+		size_ = 0;
+		last = 0;
+	}
+
+	std::size_t size() const { return size_; }
+
+private:
+	using Bits = typename std::make_unsigned<Key>::type;
+
+	constexpr static int bits_size = std::numeric_limits<Bits>::digits;
+
+	// keeps the order of signed keys, by moving negative ones below the
+	// positive ones
+	static Bits to_bits(Key key) {
+		Bits bits = static_cast<Bits>(key);
+		if (std::is_signed<Key>::value)
+			bits ^= Bits{1} << (bits_size - 1);
+		return bits;
+	}
+
+	// 0 for keys equal to the last key, otherwise one plus the index of the
+	// highest bit in which they differ
+	std::size_t bucket(Bits bits) const {
+		std::uint64_t diff = bits ^ last;
+		if (diff == 0)
+			return 0;
+#if defined(__GNUC__)
+		return 64 - __builtin_clzll(diff);
+#else
+		std::size_t width = 0;
+		while (diff) {
+			diff >>= 1;
+			width++;
+		}
+		return width;
+#endif
+	}
+
+	// makes the smallest key the last key, so that it is in bucket 0
+	void refill() {
+		if (!buckets[0].empty())
+			return;
+		if (size_ == 0)
+			throw std::out_of_range("Heap is empty");
+		std::size_t i = 1;
+		while (buckets[i].empty())
+			i++;
+
+		auto& from = buckets[i];
+		last = to_bits(from[0].first);
+		for (std::size_t j = 1; j < from.size(); j++)
+			if (to_bits(from[j].first) < last)
+				last = to_bits(from[j].first);
+		for (std::size_t j = 0; j < from.size(); j++)
+			buckets[bucket(to_bits(from[j].first))].push_back(
+				std::move(from[j]));
+		from.clear();
+	}
+
+	ArrayList<value_type> buckets[bits_size + 1];
+	std::size_t size_{0u};
+	Bits last{0u};
+};
+
+}  // namespace structures
+
+#endif
@@ -57,6 +57,12 @@ public:
 		}
 	}
 
+	// only the last, incomplete, level of a balanced build is red
+	static void settle(
+		RBNode<T>* n, std::size_t level, std::size_t full_levels) {
+		n->color = level < full_levels ? black : red;
+	}
+
 	void print(int indent) const {
 		if (this->right)
 			this->right->print(indent + 1);
@@ -159,8 +165,6 @@ private:
 			child->parent = n->parent;
 		}
 
-		n->left = nullptr;
-		n->right = nullptr;
 		delete n;
 	}
 
@@ -249,6 +253,10 @@ public:
 template <>
 const bool traits::is_set<structures::RBTree>::value = true;
 
+/* tree trait */
+template <>
+const bool traits::is_tree<structures::RBTree>::value = true;
+
 /* name trait */
 template <>
 const std::string traits::type<structures::RBTree>::name = "RBTree";
@@ -0,0 +1,289 @@
+#ifndef STRUCTURES_ROBIN_HOOD_HASH_TABLE_H
+#define STRUCTURES_ROBIN_HOOD_HASH_TABLE_H
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include <array_list.h>
+#include <traits.h>
+#include <utils.h>
+
+namespace structures {
+
+/**
+ * @brief Linear probing HashTable with Robin Hood insertion, for high load
+ * factors
+ *
+ * @details Elements are stored inline, next to one byte per slot with its
+ * distance to the slot its hash points to, so an element costs its own size
+ * plus one byte, divided by the load factor. An insertion that meets an
+ * element closer to its own slot than the one being inserted takes its
+ * place and carries on with it, which keeps distances short and even; a
+ * lookup stops as soon as it meets an element closer to its slot than the
+ * key would be. Removals shift the following elements back by one instead
+ * of leaving tombstones.
+ *
+ * The table grows when it is 90% full, a factor that set_max_load_factor
+ * changes, and shrinks when it is less than a quarter full.
+ *
+ * @tparam T    Data type of the elements
+ * @tparam Hash Class that implements the hash function
+ */
+template <typename T, typename Hash = std::hash<T>>
+class RobinHoodHashTableWrapper {
+public:
+	RobinHoodHashTableWrapper() = default;
+
+	RobinHoodHashTableWrapper(
+		const RobinHoodHashTableWrapper<T, Hash>& other)
+		: max_load{other.max_load} {
+		// same capacity, so every element goes back to the same slot
+		if (other.size_ > 0) {
+			allocate(other.capacity_);
+			for (std::size_t i = 0; i < capacity_; i++) {
+				if (other.distances[i]) {
+					new (&slots[i]) T(other.slot(i));
+					distances[i] = other.distances[i];
+				}
+			}
+			size_ = other.size_;
+		}
+	}
+
+	RobinHoodHashTableWrapper(RobinHoodHashTableWrapper<T, Hash>&& other)
+		: distances{std::move(other.distances)}
+		, slots{std::move(other.slots)}
+		, capacity_{other.capacity_}
+		, size_{other.size_}
+		, max_load{other.max_load} {
+		other.capacity_ = 0;
+		other.size_ = 0;
+	}
+
+	RobinHoodHashTableWrapper<T, Hash>& operator=(
+		const RobinHoodHashTableWrapper<T, Hash>& other) {
+		RobinHoodHashTableWrapper<T, Hash> copy{other};
+		swap(copy);
+		return *this;
+	}
+
+	RobinHoodHashTableWrapper<T, Hash>& operator=(
+		RobinHoodHashTableWrapper<T, Hash>&& other) {
+		RobinHoodHashTableWrapper<T, Hash> copy{std::move(other)};
+		swap(copy);
+		return *this;
+	}
+
+	~RobinHoodHashTableWrapper() { destroy_all(); }
+
+	/**
+	 * @brief Inserts `data` into the table
+	 *
+	 * @return false if `data` was already in the table, otherwise true
+	 */
+	bool insert(const T& data) {
+		std::uint64_t h = hash(data);
+		if (find(data, h) != capacity_)
+			return false;
+		if (size_ + 1 > capacity_ * max_load)
+			rehash(2 * capacity_);
+		place(h, T(data));
+		return true;
+	}
+
+	/**
+	 * @brief Removes `data` from the table
+	 *
+	 * @return false if `data` was not in the table, otherwise true
+	 */
+	bool remove(const T& data) {
+		std::size_t i = find(data, hash(data));
+		if (i == capacity_)
+			return false;
+
+		// the following elements move back until one is in its own slot
+		slot(i).~T();
+		std::size_t mask = capacity_ - 1;
+		for (std::size_t j = (i + 1) & mask; distances[j] > 1;
+			 j = (j + 1) & mask) {
+			new (&slots[i]) T(std::move(slot(j)));
+			slot(j).~T();
+			distances[i] = distances[j] - 1;
+			i = j;
+		}
+		distances[i] = 0;
+		size_--;
+
+		if (capacity_ > starting_size && size_ < capacity_ / 4)
+			rehash(capacity_ / 2);
+		return true;
+	}
+
+	/**
+	 * @brief Returns true if the element is in the table
+	 */
+	bool contains(const T& data) const {
+		return find(data, hash(data)) != capacity_;
+	}
+
+	void clear() {
+		RobinHoodHashTableWrapper<T, Hash> empty;
+		empty.max_load = max_load;
+		swap(empty);
+	}
+
+	std::size_t size() const { return size_; }
+
+	/**
+	 * @brief Fraction of the slots that hold an element
+	 */
+	double load_factor() const {
+		return capacity_ ? static_cast<double>(size_) / capacity_ : 0;
+	}
+
+	/**
+	 * @brief Sets the load factor at which the table grows, below 1
+	 */
+	void set_max_load_factor(double factor) { max_load = factor; }
+
+	/**
+	 * @brief Approximate amount of bytes used by the table
+	 */
+	std::size_t memory_usage() const {
+		return sizeof(*this) + capacity_ * (sizeof(T) + 1);
+	}
+
+	/**
+	 * @brief Returns a list of the items that are on the table
+	 */
+	ArrayList<T> items() const {
+		ArrayList<T> al{size_ + 1};
+		for (std::size_t i = 0; i < capacity_; i++)
+			if (distances[i])
+				al.push_back(slot(i));
+		return al;
+	}
+
+private:
+	using Storage =
+		typename std::aligned_storage<sizeof(T), alignof(T)>::type;
+
+	const static std::size_t starting_size{16};
+	// distances are stored plus one, so that 0 marks an empty slot
+	const static std::size_t max_distance{255};
+
+	std::uint64_t hash(const T& data) const {
+		return spread_hash<Hash>(hashf(data));
+	}
+
+	T& slot(std::size_t i) { return *reinterpret_cast<T*>(&slots[i]); }
+
+	const T& slot(std::size_t i) const {
+		return *reinterpret_cast<const T*>(&slots[i]);
+	}
+
+	// the slot of `data`, or the capacity if it is not in the table
+	std::size_t find(const T& data, std::uint64_t h) const {
+		if (size_ == 0)
+			return capacity_;
+		std::size_t mask = capacity_ - 1;
+		std::size_t i = h & mask;
+		for (std::size_t d = 1; d <= distances[i]; d++) {
+			if (distances[i] == d && slot(i) == data)
+				return i;
+			i = (i + 1) & mask;
+		}
+		return capacity_;
+	}
+
+	// inserts an element that is not in the table, growing it if needed
+	void place(std::uint64_t h, T&& data) {
+		std::size_t mask = capacity_ - 1;
+		std::size_t i = h & mask;
+		std::uint8_t d = 1;
+		T carried{std::move(data)};
+		while (distances[i]) {
+			if (distances[i] < d) {
+				std::swap(carried, slot(i));
+				std::swap(d, distances[i]);
+			}
+			i = (i + 1) & mask;
+			if (++d == max_distance) {
+				rehash(2 * capacity_);
+				place(hash(carried), std::move(carried));
+				return;
+			}
+		}
+		new (&slots[i]) T(std::move(carried));
+		distances[i] = d;
+		size_++;
+	}
+
+	void allocate(std::size_t capacity) {
+		distances.reset(new std::uint8_t[capacity]);
+		std::memset(distances.get(), 0, capacity);
+		slots.reset(new Storage[capacity]);
+		capacity_ = capacity;
+	}
+
+	// moves the elements to a table with `new_capacity` slots
+	void rehash(std::size_t new_capacity) {
+		if (new_capacity < starting_size)
+			new_capacity = starting_size;
+
+		RobinHoodHashTableWrapper<T, Hash> table;
+		table.max_load = max_load;
+		table.allocate(new_capacity);
+		for (std::size_t i = 0; i < capacity_; i++) {
+			if (distances[i]) {
+				table.place(hash(slot(i)), std::move(slot(i)));
+				slot(i).~T();
+				distances[i] = 0;
+			}
+		}
+		size_ = 0;
+		swap(table);
+	}
+
+	void destroy_all() {
+		for (std::size_t i = 0; i < capacity_; i++)
+			if (distances[i])
+				slot(i).~T();
+	}
+
+	void swap(RobinHoodHashTableWrapper<T, Hash>& other) {
+		std::swap(distances, other.distances);
+		std::swap(slots, other.slots);
+		std::swap(capacity_, other.capacity_);
+		std::swap(size_, other.size_);
+		std::swap(max_load, other.max_load);
+	}
+
+	std::unique_ptr<std::uint8_t[]> distances;
+	std::unique_ptr<Storage[]> slots;
+	std::size_t capacity_{0u};
+	std::size_t size_{0u};
+	double max_load{0.9};
+
+	Hash hashf{};
+};
+
+template <typename T>
+class RobinHoodHashTable : public RobinHoodHashTableWrapper<T> {};
+
+}  // namespace structures
+
+/* set trait */
+template <>
+const bool traits::is_set<structures::RobinHoodHashTable>::value = true;
+
+/* name trait */
+template <>
+const std::string traits::type<structures::RobinHoodHashTable>::name =
+	"RobinHoodHashTable";
+
+#endif
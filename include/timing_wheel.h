@@ -0,0 +1,277 @@
+#ifndef STRUCTURES_TIMING_WHEEL_H
+#define STRUCTURES_TIMING_WHEEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+
+#include <array_list.h>
+#include <traits.h>
+#include <utils.h>
+
+namespace structures {
+
+/**
+ * @brief Timers that expire after a delay, in a hierarchy of wheels
+ *
+ * @details Time is split into ticks of `tick` units. Each level of the
+ * hierarchy is a wheel of 64 slots: a slot of level 0 holds the timers of
+ * one tick, and a slot of level l those of 64^l ticks. A timer goes to the
+ * level of the highest 6 bits in which its deadline differs from the
+ * current tick, in the slot of those bits. When the current tick reaches a
+ * slot of a level above 0, its timers are cascaded to the lower levels, so
+ * each timer moves at most once per level before it expires.
+ *
+ * Each slot is a doubly linked circular list, like DoublyCircularList, of
+ * nodes in a pool where every slot has a sentinel node. Timers are nodes,
+ * and their handles are their positions in the pool, so scheduling and
+ * cancelling take constant time, and expiring takes amortized constant time
+ * per timer. The handle of an expired or cancelled timer is reused by a
+ * later schedule.
+ *
+ * The levels are as many as needed for the delays up to `horizon` units.
+ * While the lower levels have no timers, advance skips their ticks, so
+ * time may pass in large steps.
+ *
+ * @tparam T Data type of the timers
+ */
+template <typename T>
+class TimingWheelWrapper {
+public:
+	using Handle = std::size_t;
+
+	/**
+	 * @brief A wheel of ticks of `tick` units, for delays up to `horizon`
+	 * units
+	 */
+	explicit TimingWheelWrapper(
+		std::uint64_t tick = 1, std::uint64_t horizon = std::uint64_t{1} << 32)
+		: tick_{tick}, horizon_{horizon} {
+		if (tick == 0)
+			throw std::invalid_argument("Tick must be positive");
+		// the top level must not wrap around before the timers in it are
+		// cascaded, which leaves 63 of its slots for delays
+		std::uint64_t reach = slots - 1;
+		for (levels = 1; reach < horizon / tick + 3; levels++) {
+			if (levels == 64 / bits)
+				break;
+			reach <<= bits;
+		}
+		for (std::size_t i = 0; i < levels * slots; i++)
+			nodes.push_back(Node{T{}, 0, i, i});
+	}
+
+	/**
+	 * @brief Schedules `data` to expire once `delay` units have passed
+	 *
+	 * @details The timer expires at the first tick at or after now() +
+	 * `delay`, and never at a tick that already passed.
+	 *
+	 * @return The handle of the timer
+	 */
+	Handle schedule(std::uint64_t delay, T data) {
+		if (delay > horizon_)
+			throw std::invalid_argument("Delay beyond the horizon");
+		std::uint64_t deadline = (now_ + delay) / tick_;
+		if (deadline * tick_ < now_ + delay)
+			deadline++;
+		if (deadline <= current)
+			deadline = current + 1;
+
+		Handle handle;
+		if (free_handles.empty()) {
+			handle = nodes.size();
+			nodes.push_back(Node{std::move(data), deadline, npos, npos});
+		} else {
+			handle = free_handles.pop_back();
+			nodes[handle].data = std::move(data);
+			nodes[handle].deadline = deadline;
+		}
+		insert(handle);
+		size_++;
+		return handle;
+	}
+
+	/**
+	 * @brief Cancels the timer of `handle`
+	 *
+	 * @return The data of the timer
+	 */
+	T cancel(Handle handle) {
+		if (!contains(handle))
+			throw std::out_of_range("Timer is not scheduled");
+		return release(handle);
+	}
+
+	/**
+	 * @brief Whether the timer of `handle` is still scheduled
+	 */
+	bool contains(Handle handle) const {
+		return handle >= levels * slots && handle < nodes.size() &&
+			nodes[handle].prev != npos;
+	}
+
+	/**
+	 * @brief const ref to the data of the timer of `handle`
+	 */
+	const T& data(Handle handle) const { return nodes[handle].data; }
+
+	/**
+	 * @brief Lets `elapsed` units pass, calling `expire` with the data of
+	 * each timer that expires, earlier deadlines first
+	 *
+	 * @details `expire` may schedule and cancel timers.
+	 *
+	 * @return The amount of timers expired
+	 */
+	template <typename F>
+	std::size_t advance(std::uint64_t elapsed, F expire) {
+		const std::uint64_t end = now_ + elapsed, target = end / tick_;
+		std::size_t expired = 0;
+		while (current < target) {
+			// skips to the next tick that cascades the lowest level with
+			// timers, as no earlier tick has timers to expire
+			std::size_t lowest = 0;
+			while (lowest < levels && counts[lowest] == 0)
+				lowest++;
+			if (lowest == levels) {
+				current = target;
+				break;
+			}
+			std::uint64_t next =
+				((current >> (lowest * bits)) + 1) << (lowest * bits);
+			if (next > target) {
+				current = target;
+				break;
+			}
+			current = next;
+			now_ = current * tick_;
+			for (std::size_t level = levels - 1; level > 0; level--)
+				if ((current & ((std::uint64_t{1} << (level * bits)) - 1)) == 0)
+					cascade(level);
+
+			std::size_t sentinel = current & (slots - 1);
+			while (nodes[sentinel].next != sentinel) {
+				prefetch(&nodes[nodes[nodes[sentinel].next].next]);
+				expire(release(nodes[sentinel].next));
+				expired++;
+			}
+		}
+		now_ = end;
+		return expired;
+	}
+
+	/**
+	 * @brief The time, in units, since the wheel was created
+	 */
+	std::uint64_t now() const { return now_; }
+
+	std::uint64_t tick() const { return tick_; }
+
+	std::uint64_t horizon() const { return horizon_; }
+
+	/**
+	 * @brief Cancels every timer
+	 */
+	void clear() {
+		nodes.clear();
+		free_handles.clear();
+		for (std::size_t i = 0; i < levels * slots; i++)
+			nodes.push_back(Node{T{}, 0, i, i});
+		for (auto& count : counts)
+			count = 0;
+		size_ = 0;
+	}
+
+	/**
+	 * @brief Amount of timers scheduled
+	 */
+	std::size_t size() const { return size_; }
+
+private:
+	constexpr static std::size_t bits = 6;
+	constexpr static std::size_t slots = std::size_t{1} << bits;
+	constexpr static std::size_t npos = ~std::size_t{0};
+
+	struct Node {
+		T data;
+		std::uint64_t deadline;
+		std::size_t prev, next;
+	};
+
+	// the level of the highest bits in which `deadline` differs from the
+	// current tick, which stays the same until the timer is cascaded
+	std::size_t level_of(std::uint64_t deadline) const {
+		std::uint64_t diff = deadline ^ current;
+		std::size_t level = 0;
+		while (level + 1 < levels && (diff >> ((level + 1) * bits)) != 0)
+			level++;
+		return level;
+	}
+
+	// links the timer of `handle` at the end of its slot
+	void insert(Handle handle) {
+		std::uint64_t deadline = nodes[handle].deadline;
+		std::size_t level = level_of(deadline);
+		std::size_t sentinel =
+			level * slots + ((deadline >> (level * bits)) & (slots - 1));
+		counts[level]++;
+
+		Node& node = nodes[handle];
+		node.next = sentinel;
+		node.prev = nodes[sentinel].prev;
+		nodes[node.prev].next = handle;
+		nodes[sentinel].prev = handle;
+	}
+
+	T release(Handle handle) {
+		Node& node = nodes[handle];
+		nodes[node.prev].next = node.next;
+		nodes[node.next].prev = node.prev;
+		counts[level_of(node.deadline)]--;
+		nodes[handle].prev = npos;
+		free_handles.push_back(handle);
+		size_--;
+		return std::move(nodes[handle].data);
+	}
+
+	// moves the timers of the current slot of `level` to lower levels,
+	// emptying the slot at once instead of unlinking each timer
+	void cascade(std::size_t level) {
+		std::size_t sentinel =
+			level * slots + ((current >> (level * bits)) & (slots - 1));
+		Handle handle = nodes[sentinel].next;
+		nodes[sentinel].next = nodes[sentinel].prev = sentinel;
+		while (handle != sentinel) {
+			Handle next = nodes[handle].next;
+			prefetch(&nodes[next]);
+			counts[level]--;
+			insert(handle);
+			handle = next;
+		}
+	}
+
+	ArrayList<Node> nodes;
+	ArrayList<Handle> free_handles;
+	std::size_t counts[64 / bits]{};  // timers in each level
+	std::size_t levels;
+	std::uint64_t tick_, horizon_;
+	std::uint64_t current{0u};  // the last tick expired
+	std::uint64_t now_{0u};
+	std::size_t size_{0u};
+};
+
+template <typename T>
+class TimingWheel : public TimingWheelWrapper<T> {
+public:
+	using TimingWheelWrapper<T>::TimingWheelWrapper;
+};
+
+}  // namespace structures
+
+/* name trait */
+template <>
+const std::string traits::type<structures::TimingWheel>::name = "TimingWheel";
+
+#endif
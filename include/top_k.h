@@ -0,0 +1,120 @@
+#ifndef STRUCTURES_TOP_K_H
+#define STRUCTURES_TOP_K_H
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+
+#include <array_list.h>
+#include <heap.h>
+#include <traits.h>
+
+namespace structures {
+
+/**
+ * @brief Keeps the `k` larger elements of a stream
+ *
+ * @details The elements kept are in a Heap with the smaller one on top, so
+ * memory stays at `k` elements however long the stream is. Once `k`
+ * elements are kept, an element that is not larger than the top is rejected
+ * with a single comparison, and one that is replaces the top with a single
+ * sift. On a long random stream, nearly all elements are rejected.
+ *
+ * Each thread may fill its own TopK over part of a stream, and then merge
+ * them into one.
+ *
+ * @tparam          T Data type of the elements
+ * @tparam Comparator Type providing a strict weak ordering function
+ */
+template <typename T, typename Comparator = std::less<T>>
+class TopKWrapper {
+public:
+	explicit TopKWrapper(std::size_t k = 0) : k_{k} {}
+
+	/**
+	 * @brief Offers `data` to the kept elements
+	 *
+	 * @return true if `data` was kept, otherwise false
+	 */
+	bool push(const T& data) {
+		if (heap.size() < k_) {
+			heap.push(data);
+			return true;
+		}
+		if (k_ == 0 || !comp(heap.top(), data))
+			return false;
+		heap.replace_top(data);
+		return true;
+	}
+
+	bool push(T&& data) {
+		if (heap.size() < k_) {
+			heap.push(std::move(data));
+			return true;
+		}
+		if (k_ == 0 || !comp(heap.top(), data))
+			return false;
+		heap.replace_top(std::move(data));
+		return true;
+	}
+
+	/**
+	 * @brief Offers the elements kept by `other`
+	 */
+	void merge(const TopKWrapper<T, Comparator>& other) {
+		auto list = other.items();
+		for (std::size_t i = 0; i < list.size(); i++)
+			push(std::move(list[i]));
+	}
+
+	/**
+	 * @brief The kept elements, larger first
+	 */
+	ArrayList<T> items() const {
+		auto copy = heap;
+		ArrayList<T> al{copy.size() + 1};
+		while (copy.size() > 0)
+			al.push_back(copy.pop());
+		for (std::size_t i = 0; i < al.size() / 2; i++)
+			std::swap(al[i], al[al.size() - 1 - i]);
+		return al;
+	}
+
+	/**
+	 * @brief const ref to the smaller element kept, which an element must
+	 * beat to be kept once `k` are
+	 */
+	const T& threshold() const { return heap.top(); }
+
+	void clear() { heap.clear(); }
+
+	std::size_t size() const { return heap.size(); }
+
+	std::size_t k() const { return k_; }
+
+private:
+	// puts the smaller element on top of the heap
+	struct Reversed {
+		bool operator()(const T& a, const T& b) const { return comp(b, a); }
+
+		Comparator comp;
+	};
+
+	HeapWrapper<T, Reversed> heap;
+	std::size_t k_;
+	Comparator comp;
+};
+
+template <typename T>
+class TopK : public TopKWrapper<T> {
+public:
+	using TopKWrapper<T>::TopKWrapper;
+};
+
+}  // namespace structures
+
+/* name trait */
+template <>
+const std::string traits::type<structures::TopK>::name = "TopK";
+
+#endif
@@ -15,6 +15,11 @@ struct is_set {
 	const static bool value;
 };
 
+template <template <typename> class>
+struct is_tree {
+	const static bool value;
+};
+
 template <template <typename> class>
 struct type {
 	const static std::string name;
@@ -25,6 +30,8 @@ const bool is_list<T>::value = false;
 template <template <typename> class T>
 const bool is_set<T>::value = false;
 template <template <typename> class T>
+const bool is_tree<T>::value = false;
+template <template <typename> class T>
 const std::string type<T>::name = "unknown";
 
 }  // namespace traits
@@ -1,7 +1,13 @@
 #ifndef TREE_H
 #define TREE_H
 
+#include <algorithm>
+#include <memory>
+
 #include <array_list.h>
+#include <fork_join.h>
+#include <frozen_set.h>
+#include <utils.h>
 
 namespace structures {
 
@@ -18,12 +24,8 @@ class Tree {
 public:
 	Tree() = default;
 
-	Tree(const Tree<T, N>& other) {
-		auto list = other.items();
-		for (std::size_t i = 0; i < list.size(); i++) {
-			insert(list[i]);
-		}
-	}
+	Tree(const Tree<T, N>& other)
+		: root{clone(other.root)}, size_{other.size_} {}
 
 	Tree(Tree<T, N>&& other) : root{other.root}, size_{other.size_} {
 		other.root = nullptr;
@@ -47,7 +49,7 @@ public:
 	/**
 	 * @brief Destructor
 	 */
-	~Tree() { delete root; }
+	~Tree() { destroy(root); }
 
 	/**
 	 * @brief Inserts 'data' into the tree
@@ -73,14 +75,7 @@ public:
 					root->data = root->substitute();
 					N::remove((N*) root->right, root->data);
 				} else {
-					N* n;
-					if (root->right) {
-						n = (N*) root->right;
-						root->right = nullptr;  // Avoids recursive deletion
-					} else {
-						n = (N*) root->left;
-						root->left = nullptr;  // Avoids recursive deletion
-					}
+					N* n = (N*) (root->right ? root->right : root->left);
 
 					delete root;
 					root = (N*) n;
@@ -106,9 +101,85 @@ public:
 		return root ? root->contains(data) : false;
 	}
 
+	/**
+	 * @brief Sets `out[i]` to whether the tree contains `keys[i]`
+	 *
+	 * @details Several searches descend the tree at once, one level of each
+	 * in turn, and the next node of each is prefetched while the others
+	 * advance, so their cache misses overlap. A finished search is replaced
+	 * by the next key right away (asynchronous memory access chaining).
+	 */
+	void contains_many(const T* keys, std::size_t n, bool* out) const {
+		if (!root) {
+			std::fill(out, out + n, false);
+			return;
+		}
+
+		const N* at[batch];
+		std::size_t key[batch];
+		std::size_t next = 0, busy = 0;
+		for (std::size_t s = 0; s < batch; s++) {
+			at[s] = next < n ? root : nullptr;
+			if (at[s]) {
+				key[s] = next++;
+				busy++;
+			}
+		}
+
+		while (busy > 0) {
+			for (std::size_t s = 0; s < batch; s++) {
+				const N* node = at[s];
+				if (!node)
+					continue;
+
+				const T& k = keys[key[s]];
+				bool found = node->data == k;
+				node = found ? nullptr
+							 : (const N*) (k < node->data ? node->left
+														  : node->right);
+				if (node) {
+					prefetch(node);
+				} else {
+					out[key[s]] = found;
+					if (next < n) {
+						key[s] = next++;
+						node = root;
+					} else {
+						busy--;
+					}
+				}
+				at[s] = node;
+			}
+		}
+	}
+
+	/**
+	 * @brief Inserts `n` keys, returns how many were not in the tree yet
+	 *
+	 * @details Rebalancing forbids interleaving insertions, so they are done
+	 * in increasing order instead: consecutive ones share most of their path,
+	 * which is still in the cache.
+	 */
+	std::size_t insert_many(const T* keys, std::size_t n) {
+		ArrayList<T> sorted{n + 1};
+		for (std::size_t i = 0; i < n; i++)
+			sorted.push_back(keys[i]);
+		if (n > 0)
+			std::sort(&sorted[0], &sorted[0] + n);
+
+		std::size_t inserted = 0;
+		for (std::size_t i = 0; i < n; i++)
+			inserted += insert(sorted[i]);
+		return inserted;
+	}
+
+	/**
+	 * @brief Removes all the elements of the tree, in O(n)
+	 */
 	void clear() {
-		while (size_ > 0)
-			remove(root->data);
+		destroy(root);
+		root = nullptr;
+		size_ = 0;
 	}
 
 	/**
@@ -116,7 +187,7 @@ public:
 	 */
 	std::size_t size() const { return size_; }
 
-	ArrayList<T> items() const { return std::move(ArrayList<T>{pre_order()}); }
+	ArrayList<T> items() const { return pre_order(); }
 
 	/**
 	 * @brief Returns a pre-ordered list of the tree
@@ -148,6 +219,49 @@ public:
 		return out;
 	}
 
+	/**
+	 * @brief Returns an immutable copy of the tree, optimized for searches
+	 *
+	 * @tparam F Either FrozenSet or FrozenBlockedSet
+	 */
+	template <typename F = FrozenSet<T>>
+	F freeze() const {
+		return F{in_order()};
+	}
+
+	/**
+	 * @brief Replaces the contents of the tree with a sorted list
+	 *
+	 * @details The tree is built bottom-up in O(n), perfectly balanced, and
+	 * both halves are built concurrently above fork_join::cutoff.
+	 *
+	 * @param sorted A list in strictly increasing order
+	 */
+	void assign_sorted(const ArrayList<T>& sorted) {
+		assign_sorted(sorted.size() ? &sorted[0] : nullptr, sorted.size());
+	}
+
+	/**
+	 * @brief Makes this tree the union of `a` and `b`
+	 */
+	void assign_union(const Tree<T, N>& a, const Tree<T, N>& b) {
+		assign_merge<Union>(a, b);
+	}
+
+	/**
+	 * @brief Makes this tree the intersection of `a` and `b`
+	 */
+	void assign_intersection(const Tree<T, N>& a, const Tree<T, N>& b) {
+		assign_merge<Intersection>(a, b);
+	}
+
+	/**
+	 * @brief Makes this tree the elements of `a` that are not in `b`
+	 */
+	void assign_difference(const Tree<T, N>& a, const Tree<T, N>& b) {
+		assign_merge<Difference>(a, b);
+	}
+
 	/**
 	 * @brief Prints the tree sideways
 	 */
@@ -164,10 +278,353 @@ public:
 	}
 
 protected:
+	// searches that contains_many runs at once
+	const static std::size_t batch{16};
+
+	enum Operation { Union, Intersection, Difference };
+
+	template <Operation op>
+	void assign_merge(const Tree<T, N>& a, const Tree<T, N>& b) {
+		std::size_t depth = a.size_ + b.size_ >= fork_join::cutoff
+			? fork_join::max_depth()
+			: 0;
+		std::unique_ptr<T[]> left = a.flatten(depth), right = b.flatten(depth);
+		std::unique_ptr<T[]> merged{new T[a.size_ + b.size_ + 1]};
+		std::unique_ptr<Chunk[]> chunks{new Chunk[std::size_t{1} << depth]};
+		merge<op>(
+			left.get(), a.size_, right.get(), b.size_, merged.get(),
+			chunks.get(), depth);
+		if (depth == 0) {
+			assign_sorted(merged.get(), chunks[0].size);
+			return;
+		}
+
+		// moves the chunks next to each other, each one by its own thread
+		std::size_t n = 0;
+		for (std::size_t i = 0; i < (std::size_t{1} << depth); i++) {
+			chunks[i].offset = n;
+			n += chunks[i].size;
+		}
+		std::unique_ptr<T[]> out{new T[n + 1]};
+		gather(chunks.get(), out.get(), depth);
+		assign_sorted(out.get(), n);
+	}
+
+	// the output of one of the concurrent merges
+	struct Chunk {
+		const T* data;
+		std::size_t size, offset;
+	};
+
+	/*
+	 * Merges the sorted ranges `a` and `b` into `chunks`, which has room for
+	 * 2^depth of them. Both ranges are split around the same pivot, so equal
+	 * elements always end up in the same half, and the halves are merged
+	 * concurrently into disjoint slices of `out`, which has room for
+	 * `na + nb` elements.
+	 */
+	template <Operation op>
+	static void merge(
+		const T* a, std::size_t na, const T* b, std::size_t nb, T* out,
+		Chunk* chunks, std::size_t depth) {
+		if (depth == 0 || na + nb < fork_join::cutoff) {
+			chunks[0] = Chunk{out, merge_sequential<op>(a, na, b, nb, out), 0};
+			for (std::size_t i = 1; i < (std::size_t{1} << depth); i++)
+				chunks[i] = Chunk{out, 0, 0};
+			return;
+		}
+
+		const T& pivot = na > nb ? a[na / 2] : b[nb / 2];
+		std::size_t ia = std::lower_bound(a, a + na, pivot) - a;
+		std::size_t ib = std::lower_bound(b, b + nb, pivot) - b;
+		std::size_t half = std::size_t{1} << (depth - 1);
+		fork_join::invoke(
+			true,
+			[&] {
+				merge<op>(
+					a + ia, na - ia, b + ib, nb - ib, out + ia + ib,
+					chunks + half, depth - 1);
+			},
+			[&] { merge<op>(a, ia, b, ib, out, chunks, depth - 1); });
+	}
+
+	// copies the 2^depth `chunks` to their offsets in `out`
+	static void gather(Chunk* chunks, T* out, std::size_t depth) {
+		if (depth == 0) {
+			std::copy(
+				chunks[0].data, chunks[0].data + chunks[0].size,
+				out + chunks[0].offset);
+			return;
+		}
+		std::size_t half = std::size_t{1} << (depth - 1);
+		fork_join::invoke(
+			true, [&] { gather(chunks + half, out, depth - 1); },
+			[&] { gather(chunks, out, depth - 1); });
+	}
+
+	template <Operation op>
+	static std::size_t merge_sequential(
+		const T* a, std::size_t na, const T* b, std::size_t nb, T* out) {
+		std::size_t i = 0, j = 0, k = 0;
+		while (i < na && j < nb) {
+			if (a[i] < b[j]) {
+				if (op != Intersection)
+					out[k++] = a[i];
+				i++;
+			} else if (b[j] < a[i]) {
+				if (op == Union)
+					out[k++] = b[j];
+				j++;
+			} else {
+				if (op != Difference)
+					out[k++] = a[i];
+				i++;
+				j++;
+			}
+		}
+		if (op != Intersection)
+			for (; i < na; i++)
+				out[k++] = a[i];
+		if (op == Union)
+			for (; j < nb; j++)
+				out[k++] = b[j];
+		return k;
+	}
+
+	/*
+	 * The elements in order, with the subtrees `depth` levels down written
+	 * concurrently: their sizes are counted first, which gives the position
+	 * of each one in the output.
+	 */
+	std::unique_ptr<T[]> flatten(std::size_t depth) const {
+		std::unique_ptr<T[]> out{new T[size_ + 1]};
+		if (depth == 0) {
+			write_in_order(root, out.get());
+			return out;
+		}
+		std::unique_ptr<std::size_t[]> sizes{
+			new std::size_t[std::size_t{2} << depth]};
+		count(root, sizes.get(), 1, depth);
+		flatten(root, out.get(), sizes.get(), 1, depth);
+		return out;
+	}
+
+	/*
+	 * Sets sizes[i] to the amount of nodes under `n`, and the sizes of its
+	 * subtrees at sizes[2i] and sizes[2i + 1], like the positions of a
+	 * binary heap, down to `depth` levels. Both subtrees are counted
+	 * concurrently.
+	 */
+	static std::size_t count(
+		const N* n, std::size_t* sizes, std::size_t i, std::size_t depth) {
+		if (depth == 0)
+			return sizes[i] = count(n);
+		const N* left = n ? (const N*) n->left : nullptr;
+		const N* right = n ? (const N*) n->right : nullptr;
+		std::size_t l, r;
+		fork_join::invoke(
+			n != nullptr, [&] { l = count(left, sizes, 2 * i, depth - 1); },
+			[&] { r = count(right, sizes, 2 * i + 1, depth - 1); });
+		return sizes[i] = n ? 1 + l + r : 0;
+	}
+
+	static std::size_t count(const N* n) {
+		std::size_t size = 0;
+		in_order(n, [&size](const N*) { size++; });
+		return size;
+	}
+
+	static void flatten(
+		const N* n, T* out, const std::size_t* sizes, std::size_t i,
+		std::size_t depth) {
+		if (!n)
+			return;
+		if (depth == 0) {
+			write_in_order(n, out);
+			return;
+		}
+		std::size_t left = sizes[2 * i];
+		out[left] = n->data;
+		fork_join::invoke(
+			true,
+			[&] { flatten((const N*) n->left, out, sizes, 2 * i, depth - 1); },
+			[&] {
+				flatten(
+					(const N*) n->right, out + left + 1, sizes, 2 * i + 1,
+					depth - 1);
+			});
+	}
+
+	// writes the subtree of `n` in order, returns the end of the output
+	static T* write_in_order(const N* n, T* out) {
+		in_order(n, [&out](const N* node) { *out++ = node->data; });
+		return out;
+	}
+
+	/*
+	 * Calls `visit` on the nodes of the subtree of `n` in order, walking it
+	 * through the parent pointers, so that a degenerate tree takes no stack.
+	 */
+	template <typename F>
+	static void in_order(const N* n, F visit) {
+		if (n == nullptr)
+			return;
+		const N* end = (const N*) n->parent;
+		while (n->left)
+			n = (const N*) n->left;
+		while (n != end) {
+			visit(n);
+			if (n->right) {
+				n = (const N*) n->right;
+				while (n->left)
+					n = (const N*) n->left;
+			} else {
+				const N* child;
+				do {
+					child = n;
+					n = (const N*) n->parent;
+				} while (n != end && n->right == child);
+			}
+		}
+	}
+
+	/*
+	 * Copies the shape of a tree, and the whole nodes (so AVL heights and RB
+	 * colors are kept), walking it through the parent pointers.
+	 */
+	static N* clone(const N* source) {
+		if (source == nullptr)
+			return nullptr;
+
+		auto copy_node = [](const N* n, N* parent) {
+			N* copy = new N(*n);
+			copy->parent = parent;
+			copy->left = nullptr;
+			copy->right = nullptr;
+			return copy;
+		};
+
+		N* copy = copy_node(source, nullptr);
+		const N* s = source;
+		N* c = copy;
+		while (true) {
+			if (s->left && !c->left) {
+				c->left = copy_node((const N*) s->left, c);
+				s = (const N*) s->left;
+				c = (N*) c->left;
+			} else if (s->right && !c->right) {
+				c->right = copy_node((const N*) s->right, c);
+				s = (const N*) s->right;
+				c = (N*) c->right;
+			} else if (s == source) {
+				return copy;
+			} else {
+				s = (const N*) s->parent;
+				c = (N*) c->parent;
+			}
+		}
+	}
+
+	/*
+	 * Deletes a whole tree in O(n) without recursion, by rotating left
+	 * children up until the top node has no left child, then deleting it.
+	 */
+	static void destroy(N* n) {
+		while (n) {
+			if (n->left) {
+				N* left = (N*) n->left;
+				n->left = left->right;
+				left->right = n;
+				n = left;
+			} else {
+				N* right = (N*) n->right;
+				delete n;
+				n = right;
+			}
+		}
+	}
+
+	void assign_sorted(const T* sorted, std::size_t n) {
+		clear();
+		std::size_t full_levels = 0;
+		while ((std::size_t{2} << full_levels) <= n + 1)
+			++full_levels;
+		root = build(sorted, n, 0, full_levels, fork_join::max_depth());
+		size_ = n;
+	}
+
+	/*
+	 * Builds a perfectly balanced subtree, levels below `full_levels` are
+	 * complete, so nodes can set their balancing information (height,
+	 * color) knowing only their level and their already built children.
+	 */
+	static N* build(
+		const T* sorted, std::size_t n, std::size_t level,
+		std::size_t full_levels, std::size_t depth) {
+		if (n == 0)
+			return nullptr;
+
+		std::size_t mid = n / 2;
+		N* node = new N(sorted[mid]);
+		N* left;
+		N* right;
+		fork_join::invoke(
+			depth > 0 && n >= fork_join::cutoff,
+			[&] {
+				left = build(
+					sorted, mid, level + 1, full_levels,
+					depth ? depth - 1 : 0);
+			},
+			[&] {
+				right = build(
+					sorted + mid + 1, n - mid - 1, level + 1, full_levels,
+					depth ? depth - 1 : 0);
+			});
+
+		node->left = left;
+		node->right = right;
+		if (left)
+			left->parent = node;
+		if (right)
+			right->parent = node;
+		N::settle(node, level, full_levels);
+		return node;
+	}
+
 	N* root{nullptr};
 	std::size_t size_{0u};
 };
 
+/**
+ * @brief Returns a tree with the elements that are in `a` or in `b`
+ */
+template <typename S>
+S set_union(const S& a, const S& b) {
+	S out;
+	out.assign_union(a, b);
+	return out;
+}
+
+/**
+ * @brief Returns a tree with the elements that are both in `a` and in `b`
+ */
+template <typename S>
+S set_intersection(const S& a, const S& b) {
+	S out;
+	out.assign_intersection(a, b);
+	return out;
+}
+
+/**
+ * @brief Returns a tree with the elements of `a` that are not in `b`
+ */
+template <typename S>
+S set_difference(const S& a, const S& b) {
+	S out;
+	out.assign_difference(a, b);
+	return out;
+}
+
 }  // namespace structures
 
 #endif
@@ -1,7 +1,9 @@
 #ifndef STRUCTURES_UTILS_H
 #define STRUCTURES_UTILS_H
 
+#include <cstdint>
 #include <memory>
+#include <type_traits>
 
 #if __cplusplus < 201402L
 template <typename T, typename... Args>
@@ -20,4 +22,46 @@ typename std::enable_if<std::is_array<T>::value, std::unique_ptr<T>>::
 using std::make_unique;
 #endif
 
+/**
+ * @brief Hints the processor to bring `address` into the cache
+ *
+ * @details It never faults, so it may be called with any address, e.g. past
+ * the end of an array.
+ */
+inline void prefetch(const void* address) {
+#if defined(__GNUC__)
+	__builtin_prefetch(address);
+#else
+	(void) address;
+#endif
+}
+
+/**
+ * @brief Spreads the bits of a hash, so that identity hashes (e.g.
+ * std::hash of integers) still use the whole table
+ */
+inline std::uint64_t mix_hash(std::uint64_t h) {
+	h *= 0x9E3779B97F4A7C15ull;
+	return h ^ (h >> 32);
+}
+
+template <typename Hash, typename = void>
+struct is_avalanching : std::false_type {};
+
+template <typename Hash>
+struct is_avalanching<Hash, std::void_t<typename Hash::is_avalanching>>
+	: std::true_type {};
+
+/**
+ * @brief Spreads the bits of `h`, a hash computed by `Hash`, unless `Hash`
+ * declares an `is_avalanching` type, i.e. its bits are already spread
+ */
+template <typename Hash>
+std::uint64_t spread_hash(std::uint64_t h) {
+	if constexpr (is_avalanching<Hash>::value)
+		return h;
+	else
+		return mix_hash(h);
+}
+
 #endif
@@ -0,0 +1,1549 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <addressable_heap.h>
+#include <array_list.h>
+#include <avl_tree.h>
+#include <b_plus_tree.h>
+#include <binary_tree.h>
+#include <concurrent_avl_tree.h>
+#include <concurrent_hash_table.h>
+#include <concurrent_priority_queue.h>
+#include <cuckoo_hash_table.h>
+#include <external_priority_queue.h>
+#include <external_sort.h>
+#include <filtered_set.h>
+#include <flat_hash_table.h>
+#include <fork_join.h>
+#include <frozen_set.h>
+#include <hash.h>
+#include <hash_map.h>
+#include <hash_table.h>
+#include <heap.h>
+#include <k_way_merge.h>
+#include <key_value_heap.h>
+#include <min_max_heap.h>
+#include <rb_tree.h>
+#include <radix_heap.h>
+#include <robin_hood_hash_table.h>
+#include <timing_wheel.h>
+#include <top_k.h>
+
+namespace {
+
+/**
+ * @brief Runs `f` once and returns how long it took in milliseconds
+ */
+template <typename F>
+double time_ms(F&& f) {
+	auto start = std::chrono::steady_clock::now();
+	f();
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+void report(const std::string& what, double ms) {
+	std::cout << "  " << what << ": " << ms << " ms" << std::endl;
+}
+
+template <typename S>
+void bench_set_operations(const std::string& name) {
+	structures::ArrayList<int> evens, threes;
+	for (int i = 0; i < 2 * BENCH_SIZE; i++) {
+		if (i % 2 == 0)
+			evens.push_back(i);
+		if (i % 3 == 0)
+			threes.push_back(i);
+	}
+
+	std::cout << name << " set operations, " << evens.size() << " and "
+			  << threes.size() << " elements" << std::endl;
+
+	auto hardware = structures::fork_join::threads();
+	for (std::size_t t = 1; t <= 16; t *= 2) {
+		structures::fork_join::threads() = t;
+		S a, b, u, n, d;
+		std::cout << " " << t << " threads" << std::endl;
+		report("assign_sorted", time_ms([&] {
+				   a.assign_sorted(evens);
+				   b.assign_sorted(threes);
+			   }));
+		report("union", time_ms([&] { u.assign_union(a, b); }));
+		report("intersection", time_ms([&] { n.assign_intersection(a, b); }));
+		report("difference", time_ms([&] { d.assign_difference(a, b); }));
+	}
+	structures::fork_join::threads() = hardware;
+
+	S inserted;
+	report("insert loop (baseline)", time_ms([&] {
+			   for (std::size_t i = 0; i < evens.size(); i++)
+				   inserted.insert(evens[i]);
+		   }));
+}
+
+void tree_set_operations() {
+	bench_set_operations<structures::AVLTree<int>>("AVLTree");
+	bench_set_operations<structures::RBTree<int>>("RBTree");
+}
+
+/**
+ * @brief `n` distinct keys in random order
+ */
+structures::ArrayList<int> random_keys(std::size_t n, unsigned seed = 42) {
+	structures::ArrayList<int> keys{n + 1};
+	for (std::size_t i = 0; i < n; i++)
+		keys.push_back(static_cast<int>(i * 2));
+	std::mt19937 rng{seed};
+	for (std::size_t i = n; i > 1; i--)
+		std::swap(keys[i - 1], keys[rng() % i]);
+	return keys;
+}
+
+template <typename S>
+void bench_ordered_set(const std::string& name, std::size_t n) {
+	auto keys = random_keys(n);
+	S set;
+	double insert = time_ms([&] {
+		for (std::size_t i = 0; i < n; i++)
+			set.insert(keys[i]);
+	});
+
+	std::size_t found = 0;
+	double lookup = time_ms([&] {
+		for (std::size_t i = 0; i < n; i++)
+			found += set.contains(keys[i]) + set.contains(keys[i] + 1);
+	});
+
+	std::size_t scanned = 0;
+	double scan = time_ms([&] { scanned = set.items().size(); });
+
+	std::cout << "  " << name << ": insert " << insert * 1e6 / n
+			  << " ns, lookup " << lookup * 1e6 / (2 * n) << " ns, scan "
+			  << scan * 1e6 / n << " ns per element" << std::endl;
+	if (found != n || scanned != n)
+		std::cout << "  wrong results!" << std::endl;
+}
+
+void ordered_sets() {
+	for (std::size_t n = 1000; n <= BENCH_SIZE; n *= 10) {
+		std::cout << " " << n << " elements" << std::endl;
+		bench_ordered_set<structures::AVLTree<int>>("AVLTree", n);
+		bench_ordered_set<structures::RBTree<int>>("RBTree", n);
+		bench_ordered_set<structures::BPlusTree<int>>("BPlusTree", n);
+	}
+}
+
+template <typename S>
+void bench_lookups(
+	const std::string& name, const S& set,
+	const structures::ArrayList<int>& keys) {
+	std::size_t found = 0;
+	double ms = time_ms([&] {
+		for (std::size_t i = 0; i < keys.size(); i++)
+			found += set.contains(keys[i]) + set.contains(keys[i] + 1);
+	});
+	std::cout << "  " << name << ": " << ms * 1e6 / (2 * keys.size())
+			  << " ns per lookup" << std::endl;
+	if (found != keys.size())
+		std::cout << "  wrong results!" << std::endl;
+}
+
+void frozen_sets() {
+	for (std::size_t n = 1000; n <= BENCH_SIZE; n *= 10) {
+		std::cout << " " << n << " elements" << std::endl;
+		auto keys = random_keys(n);
+		structures::RBTree<int> tree;
+		for (std::size_t i = 0; i < n; i++)
+			tree.insert(keys[i]);
+
+		bench_lookups("RBTree", tree, keys);
+		bench_lookups("FrozenSet", tree.freeze(), keys);
+		bench_lookups(
+			"FrozenBlockedSet",
+			tree.freeze<structures::FrozenBlockedSet<int>>(), keys);
+	}
+}
+
+template <typename S>
+void bench_turnover(const std::string& name, const S& tree) {
+	double copy_ms, assign_ms, clear_ms, destroy_ms;
+	{
+		S copy;
+		copy_ms = time_ms([&] { S other{tree}; copy = std::move(other); });
+		assign_ms = time_ms([&] { copy = tree; });
+		clear_ms = time_ms([&] { copy.clear(); });
+		copy = tree;
+		destroy_ms = time_ms([&] { S moved{std::move(copy)}; });
+	}
+	std::cout << "  " << name << ": copy " << copy_ms << " ms, assign "
+			  << assign_ms << " ms, clear " << clear_ms << " ms, destroy "
+			  << destroy_ms << " ms" << std::endl;
+}
+
+void tree_turnover() {
+	auto keys = random_keys(BENCH_SIZE);
+	std::cout << " " << BENCH_SIZE << " elements" << std::endl;
+
+	structures::AVLTree<int> avl;
+	structures::RBTree<int> rb;
+	for (std::size_t i = 0; i < keys.size(); i++) {
+		avl.insert(keys[i]);
+		rb.insert(keys[i]);
+	}
+	bench_turnover("AVLTree", avl);
+	bench_turnover("RBTree", rb);
+
+	// sorted inserts make a linked list out of an unbalanced tree
+	structures::BinaryTree<int> degenerate;
+	for (int i = 0; i < 20000; i++)
+		degenerate.insert(-i);
+	bench_turnover("BinaryTree (20000 sorted inserts)", degenerate);
+}
+
+/**
+ * @brief A set behind a readers-writer lock, what the concurrent sets replace
+ */
+template <typename S>
+class Locked {
+public:
+	bool insert(int data) {
+		std::unique_lock<std::shared_mutex> lock{mutex};
+		return set.insert(data);
+	}
+
+	bool remove(int data) {
+		std::unique_lock<std::shared_mutex> lock{mutex};
+		return set.remove(data);
+	}
+
+	bool contains(int data) const {
+		std::shared_lock<std::shared_mutex> lock{mutex};
+		return set.contains(data);
+	}
+
+private:
+	mutable std::shared_mutex mutex;
+	S set;
+};
+
+/**
+ * @brief Runs `ops` operations on `set` from each of `threads` threads, with
+ * `reads` percent of lookups and the rest split between inserts and removes
+ *
+ * @return Millions of operations per second
+ */
+template <typename S>
+double mixed_throughput(
+	S& set, std::size_t threads, std::size_t ops, unsigned reads,
+	std::size_t range) {
+	std::vector<std::thread> workers;
+	std::atomic<std::size_t> hits{0};
+	double ms = time_ms([&] {
+		for (std::size_t t = 0; t < threads; t++) {
+			workers.emplace_back([&, t] {
+				std::mt19937 rng(static_cast<unsigned>(t));
+				std::size_t local_hits = 0;
+				for (std::size_t i = 0; i < ops; i++) {
+					int key = static_cast<int>(rng() % range);
+					unsigned op = rng() % 100;
+					if (op < reads)
+						local_hits += set.contains(key);
+					else if (op % 2)
+						local_hits += set.insert(key);
+					else
+						local_hits += set.remove(key);
+				}
+				hits += local_hits;
+			});
+		}
+		for (auto& w : workers)
+			w.join();
+	});
+	if (hits == 0)
+		std::cout << "  no hits!" << std::endl;
+	return threads * ops / ms / 1e3;
+}
+
+template <typename S>
+void bench_concurrent_set(
+	const std::string& name, std::initializer_list<unsigned> mixes) {
+	const std::size_t range = BENCH_SIZE;
+	const std::size_t ops = BENCH_SIZE / 4;
+	for (unsigned reads : mixes) {
+		std::cout << "  " << name << ", " << reads << "% reads:";
+		for (std::size_t threads = 1; threads <= 32; threads *= 2) {
+			S set;
+			for (std::size_t i = 0; i < range; i += 2)
+				set.insert(static_cast<int>(i));
+			std::cout << " " << threads << "T "
+					  << mixed_throughput(set, threads, ops, reads, range);
+		}
+		std::cout << " Mops/s" << std::endl;
+	}
+}
+
+void concurrent_sets() {
+	bench_concurrent_set<Locked<structures::RBTree<int>>>(
+		"RBTree + shared_mutex", {90u, 50u});
+	bench_concurrent_set<structures::ConcurrentAVLTree<int>>(
+		"ConcurrentAVLTree", {90u, 50u});
+}
+
+void concurrent_hash_sets() {
+	bench_concurrent_set<Locked<structures::HashTable<int>>>(
+		"HashTable + shared_mutex", {90u, 10u});
+	bench_concurrent_set<structures::ConcurrentHashTable<int>>(
+		"ConcurrentHashTable", {90u, 10u});
+}
+
+template <typename S>
+void bench_hash_set(const std::string& name, std::size_t n) {
+	auto keys = random_keys(n);
+	S set;
+	double insert = time_ms([&] {
+		for (std::size_t i = 0; i < n; i++)
+			set.insert(keys[i]);
+	});
+
+	std::size_t found = 0;
+	double hits = time_ms([&] {
+		for (std::size_t i = 0; i < n; i++)
+			found += set.contains(keys[i]);
+	});
+	double misses = time_ms([&] {
+		for (std::size_t i = 0; i < n; i++)
+			found += set.contains(keys[i] + 1);
+	});
+
+	std::cout << "  " << name << ": insert " << insert * 1e6 / n
+			  << " ns, hit " << hits * 1e6 / n << " ns, miss "
+			  << misses * 1e6 / n << " ns, "
+			  << static_cast<double>(set.memory_usage()) / n
+			  << " bytes per element" << std::endl;
+	if (found != n)
+		std::cout << "  wrong results!" << std::endl;
+}
+
+void hash_sets() {
+	for (std::size_t n = 1000; n <= BENCH_SIZE; n *= 10) {
+		std::cout << " " << n << " elements" << std::endl;
+		bench_hash_set<structures::HashTable<int>>("HashTable", n);
+		bench_hash_set<structures::FlatHashTable<int>>("FlatHashTable", n);
+	}
+}
+
+/**
+ * @brief Prints the percentiles of `latencies`, and a histogram with power
+ * of two buckets
+ */
+void report_latencies(const std::string& name, std::vector<double> latencies) {
+	std::vector<std::size_t> histogram;
+	for (double ns : latencies) {
+		std::size_t bin = 0;
+		while (ns >= 2 && bin < 40) {
+			ns /= 2;
+			bin++;
+		}
+		if (histogram.size() <= bin)
+			histogram.resize(bin + 1);
+		histogram[bin]++;
+	}
+
+	std::sort(latencies.begin(), latencies.end());
+	auto percentile = [&](double p) {
+		return latencies[static_cast<std::size_t>(p * (latencies.size() - 1))];
+	};
+	std::cout << "  " << name << ": p50 " << percentile(0.5) << " ns, p99 "
+			  << percentile(0.99) << " ns, p99.9 " << percentile(0.999)
+			  << " ns, max " << latencies.back() << " ns" << std::endl;
+	std::cout << "   ";
+	for (std::size_t bin = 0; bin < histogram.size(); bin++)
+		if (histogram[bin])
+			std::cout << " <" << (2ull << bin) << "ns:" << histogram[bin];
+	std::cout << std::endl;
+}
+
+/**
+ * @brief Times every insert of `keys` into a HashTable that moves `step`
+ * buckets per operation while resizing, and then every remove, which
+ * shrinks the table down again
+ */
+void bench_resize_latency(
+	const std::string& name, std::size_t step,
+	const structures::ArrayList<int>& keys) {
+	std::vector<double> inserts(keys.size()), removes(keys.size());
+	structures::HashTable<int> set;
+	set.set_rehash_step(step);
+	for (std::size_t i = 0; i < keys.size(); i++) {
+		auto start = std::chrono::steady_clock::now();
+		set.insert(keys[i]);
+		auto end = std::chrono::steady_clock::now();
+		inserts[i] = std::chrono::duration<double, std::nano>(end - start)
+						 .count();
+	}
+	for (std::size_t i = 0; i < keys.size(); i++) {
+		auto start = std::chrono::steady_clock::now();
+		set.remove(keys[i]);
+		auto end = std::chrono::steady_clock::now();
+		removes[i] = std::chrono::duration<double, std::nano>(end - start)
+						 .count();
+	}
+	report_latencies(name + ", inserts", std::move(inserts));
+	report_latencies(name + ", removes", std::move(removes));
+}
+
+void hash_resize_latency() {
+	auto keys = random_keys(BENCH_SIZE);
+	std::cout << " " << BENCH_SIZE << " inserts, then as many removes"
+			  << std::endl;
+	bench_resize_latency("HashTable, synchronous resize", 0, keys);
+	bench_resize_latency("HashTable, 4 buckets per operation", 4, keys);
+}
+
+/**
+ * @brief Looks up every key of `map` through a std::string_view, which
+ * builds a std::string per lookup unless the map is transparent
+ */
+template <typename M>
+void bench_string_view_lookups(
+	const std::string& name, const M& map,
+	const std::vector<std::string>& keys) {
+	std::size_t found = 0;
+	double ms = time_ms([&] {
+		for (const auto& key : keys)
+			found += map.contains(std::string_view{key});
+	});
+	std::cout << "  " << name << ": " << ms * 1e6 / keys.size()
+			  << " ns per lookup" << std::endl;
+	if (found != keys.size())
+		std::cout << "  wrong results!" << std::endl;
+}
+
+void hash_map_lookups() {
+	// long enough not to fit in the small string buffer
+	std::vector<std::string> keys;
+	for (int i = 0; i < BENCH_SIZE; i++)
+		keys.push_back("a somewhat long key number " + std::to_string(i));
+
+	structures::HashMap<std::string, int> map;
+	structures::HashMap<
+		std::string, int, structures::StringHash, std::equal_to<>>
+		transparent;
+	for (int i = 0; i < BENCH_SIZE; i++) {
+		map[keys[i]] = i;
+		transparent[keys[i]] = i;
+	}
+
+	std::cout << " " << BENCH_SIZE << " keys" << std::endl;
+	bench_string_view_lookups("HashMap<std::string, int>", map, keys);
+	bench_string_view_lookups(
+		"HashMap<std::string, int, StringHash, std::equal_to<>>",
+		transparent, keys);
+}
+
+template <typename S>
+void bench_string_set(
+	const std::string& name, const std::vector<std::string>& keys) {
+	S set;
+	set.set_rehash_step(0);
+
+	// with synchronous resizes, the slowest insert is the last resize
+	double insert = 0, resize = 0;
+	for (std::size_t i = 0; i < keys.size(); i += 2) {
+		double ms = time_ms([&] { set.insert(keys[i]); });
+		insert += ms;
+		resize = std::max(resize, ms);
+	}
+
+	std::size_t found = 0;
+	double misses = time_ms([&] {
+		for (std::size_t i = 1; i < keys.size(); i += 2)
+			found += set.contains(keys[i]);
+	});
+
+	std::size_t n = keys.size() / 2;
+	std::cout << "  " << name << ": insert " << insert * 1e6 / n
+			  << " ns per element, largest resize " << resize
+			  << " ms, miss " << misses * 1e6 / n << " ns" << std::endl;
+	if (found != 0)
+		std::cout << "  wrong results!" << std::endl;
+}
+
+void string_hash_sets() {
+	// a long common prefix makes comparing strings expensive
+	std::vector<std::string> keys;
+	for (int i = 0; i < BENCH_SIZE; i++)
+		keys.push_back(std::string(64, '-') + std::to_string(i));
+
+	std::cout << " " << BENCH_SIZE / 2 << " strings" << std::endl;
+	bench_string_set<structures::HashTable<std::string>>("HashTable", keys);
+	bench_string_set<structures::CachedHashTable<std::string>>(
+		"CachedHashTable", keys);
+}
+
+template <typename S>
+void bench_batches(const std::string& name, std::size_t n) {
+	auto keys = random_keys(n);
+	S one, many;
+	double insert = time_ms([&] {
+		for (std::size_t i = 0; i < n; i++)
+			one.insert(keys[i]);
+	});
+	double insert_many = time_ms([&] { many.insert_many(&keys[0], n); });
+
+	// half hits and half misses
+	std::vector<int> probes(n);
+	for (std::size_t i = 0; i < n; i++)
+		probes[i] = keys[i] + static_cast<int>(i % 2);
+	std::unique_ptr<bool[]> out{new bool[n]};
+
+	std::size_t found = 0, found_many = 0;
+	double lookup = time_ms([&] {
+		for (std::size_t i = 0; i < n; i++)
+			found += one.contains(probes[i]);
+	});
+	double lookup_many = time_ms([&] {
+		many.contains_many(probes.data(), n, out.get());
+		for (std::size_t i = 0; i < n; i++)
+			found_many += out[i];
+	});
+
+	std::cout << "  " << name << ": insert " << insert * 1e6 / n << " -> "
+			  << insert_many * 1e6 / n << " ns, lookup " << lookup * 1e6 / n
+			  << " -> " << lookup_many * 1e6 / n << " ns" << std::endl;
+	if (found != n / 2 || found_many != found)
+		std::cout << "  wrong results!" << std::endl;
+}
+
+void batched_operations() {
+	std::cout << " " << BENCH_SIZE
+			  << " elements, one at a time -> batched" << std::endl;
+	bench_batches<structures::HashTable<int>>("HashTable", BENCH_SIZE);
+	bench_batches<structures::FlatHashTable<int>>(
+		"FlatHashTable", BENCH_SIZE);
+	bench_batches<structures::RBTree<int>>("RBTree", BENCH_SIZE);
+}
+
+void perfect_hash_sets() {
+	for (std::size_t n = 1000; n <= BENCH_SIZE; n *= 10) {
+		std::cout << " " << n << " elements" << std::endl;
+		auto keys = random_keys(n);
+		structures::HashTable<int> table;
+		structures::FlatHashTable<int> flat;
+		for (std::size_t i = 0; i < n; i++) {
+			table.insert(keys[i]);
+			flat.insert(keys[i]);
+		}
+
+		auto hardware = structures::fork_join::threads();
+		structures::fork_join::threads() = 1;
+		double sequential = time_ms([&] { table.freeze(); });
+		structures::fork_join::threads() = hardware;
+		structures::PerfectHashSet<int> frozen;
+		double parallel = time_ms([&] { frozen = table.freeze(); });
+		std::cout << "  PerfectHashSet: build " << sequential << " ms, "
+				  << parallel << " ms with " << hardware << " threads, "
+				  << frozen.bytes_per_key() << " bytes per element"
+				  << std::endl;
+
+		bench_lookups("HashTable", table, keys);
+		bench_lookups("FlatHashTable", flat, keys);
+		bench_lookups("PerfectHashSet", frozen, keys);
+	}
+}
+
+// the probes are absent keys, except one in every 20
+template <typename S>
+void bench_filtered(
+	const std::string& name, const S& set,
+	const structures::ArrayList<int>& probes) {
+	std::size_t found = 0;
+	double ms = time_ms([&] {
+		for (std::size_t i = 0; i < probes.size(); i++)
+			found += set.contains(probes[i]);
+	});
+	std::cout << "  " << name << ": " << ms * 1e6 / probes.size()
+			  << " ns per lookup";
+	if (found != (probes.size() + 19) / 20)
+		std::cout << ", wrong results!";
+}
+
+// how many absent probes the filter let through, and its size
+template <typename F>
+void report_filter(
+	const F& filter, std::size_t n, const structures::ArrayList<int>& probes) {
+	std::size_t misses = 0, positives = 0;
+	for (std::size_t i = 0; i < probes.size(); i++) {
+		if (i % 20 != 0) {
+			misses++;
+			positives += filter.contains(probes[i]);
+		}
+	}
+	std::cout << ", " << 100.0 * positives / misses << "% false positives, "
+			  << 8.0 * filter.memory_usage() / n << " bits per element"
+			  << std::endl;
+}
+
+template <template <typename> class S>
+void bench_filtered_set(const std::string& name, std::size_t n) {
+	auto keys = random_keys(n);
+	structures::ArrayList<int> probes{n + 1};
+	for (std::size_t i = 0; i < n; i++)
+		probes.push_back(keys[i] + (i % 20 != 0));
+
+	S<int> plain;
+	structures::FilteredSet<int, S, structures::BloomFilter> bloom;
+	structures::FilteredSet<int, S, structures::CuckooFilter> cuckoo;
+	for (std::size_t i = 0; i < n; i++) {
+		plain.insert(keys[i]);
+		bloom.insert(keys[i]);
+		cuckoo.insert(keys[i]);
+	}
+
+	bench_filtered(name, plain, probes);
+	std::cout << std::endl;
+	bench_filtered(name + " + BloomFilter", bloom, probes);
+	report_filter(bloom.filter(), n, probes);
+	bench_filtered(name + " + CuckooFilter", cuckoo, probes);
+	report_filter(cuckoo.filter(), n, probes);
+}
+
+void filtered_sets() {
+	std::cout << " " << BENCH_SIZE << " elements, 95% of lookups miss"
+			  << std::endl;
+	bench_filtered_set<structures::HashTable>("HashTable", BENCH_SIZE);
+	bench_filtered_set<structures::RBTree>("RBTree", BENCH_SIZE);
+	bench_filtered_set<structures::BPlusTree>("BPlusTree", BENCH_SIZE);
+}
+
+// std::hash used as it is, to show how identity hashes cluster
+template <typename T>
+struct UnmixedHash : std::hash<T> {
+	using is_avalanching = void;
+};
+
+template <typename K, typename H>
+void bench_hasher(const std::string& name, const std::vector<K>& keys) {
+	const std::size_t passes = 10;
+	H hashf;
+	std::uint64_t sum = 0;
+	double ms = time_ms([&] {
+		for (std::size_t pass = 0; pass < passes; pass++)
+			for (std::size_t i = 0; i < keys.size(); i++)
+				sum += hashf(keys[i]);
+	});
+
+	structures::HashTableWrapper<K, H> table;
+	for (std::size_t i = 0; i < keys.size(); i++)
+		table.insert(keys[i]);
+	auto counts = table.chain_lengths();
+	std::size_t buckets = 0, probes = 0;
+	for (std::size_t k = 0; k < counts.size(); k++) {
+		buckets += counts[k];
+		probes += counts[k] * k * (k + 1) / 2;
+	}
+
+	std::cout << "  " << name << ": " << ms * 1e6 / (passes * keys.size())
+			  << " ns per hash, " << 100.0 * counts[0] / buckets
+			  << "% empty buckets, longest chain " << counts.size() - 1
+			  << ", " << static_cast<double>(probes) / keys.size()
+			  << " compares per hit" << std::endl;
+	if (sum == 0)
+		std::cout << "  wrong results!" << std::endl;
+}
+
+void hash_functions() {
+	std::vector<int> sequential, strided, random;
+	std::mt19937 rng{42};
+	for (int i = 0; i < BENCH_SIZE; i++) {
+		sequential.push_back(i);
+		strided.push_back(i * 64);
+		random.push_back(static_cast<int>(rng()));
+	}
+	for (auto keys : {&sequential, &strided, &random}) {
+		std::cout << " " << BENCH_SIZE
+				  << (keys == &sequential
+						  ? " sequential"
+						  : keys == &strided ? " strided" : " random")
+				  << " integers" << std::endl;
+		bench_hasher<int, std::hash<int>>("std::hash", *keys);
+		bench_hasher<int, UnmixedHash<int>>("std::hash, unmixed", *keys);
+		bench_hasher<int, structures::IntegerHash>("IntegerHash", *keys);
+	}
+
+	std::vector<std::string> ids, urls, text;
+	for (int i = 0; i < BENCH_SIZE; i++) {
+		ids.push_back("user:" + std::to_string(i));
+		urls.push_back(
+			"https://example.com/catalog/items/" + std::to_string(i) +
+			"?ref=home&page=" + std::to_string(i % 100));
+		std::string word(8 + rng() % 57, ' ');
+		for (auto& c : word)
+			c = static_cast<char>('a' + rng() % 26);
+		text.push_back(word);
+	}
+	for (auto keys : {&ids, &urls, &text}) {
+		std::size_t bytes = 0;
+		for (auto& key : *keys)
+			bytes += key.size();
+		const char* kind =
+			keys == &ids ? " ids" : keys == &urls ? " urls" : " words";
+		std::cout << " " << BENCH_SIZE << kind << " of "
+				  << bytes / keys->size() << " bytes on average" << std::endl;
+		bench_hasher<std::string, std::hash<std::string>>("std::hash", *keys);
+		bench_hasher<std::string, structures::WyHash>("WyHash", *keys);
+		bench_hasher<std::string, structures::XXH3Hash>("XXH3Hash", *keys);
+	}
+}
+
+template <typename S>
+void bench_compact_set(
+	const std::string& name, const structures::ArrayList<int>& keys) {
+	std::size_t n = keys.size();
+	S set;
+	double insert = time_ms([&] {
+		for (std::size_t i = 0; i < n; i++)
+			set.insert(keys[i]);
+	});
+
+	std::size_t hits = 0, misses = 0;
+	double hit = time_ms([&] {
+		for (std::size_t i = 0; i < n; i++)
+			hits += set.contains(keys[i]);
+	});
+	double miss = time_ms([&] {
+		for (std::size_t i = 0; i < n; i++)
+			misses += set.contains(keys[i] + 1);
+	});
+
+	std::cout << "  " << name << ": "
+			  << static_cast<double>(set.memory_usage()) / n
+			  << " bytes per element, insert " << insert * 1e6 / n
+			  << " ns, hit " << hit * 1e6 / n << " ns, miss "
+			  << miss * 1e6 / n << " ns" << std::endl;
+	if (hits != n || misses != 0)
+		std::cout << "  wrong results!" << std::endl;
+}
+
+void compact_hash_sets() {
+	// the chained table needs several times the memory of the others
+	const std::size_t chained_limit = 10 * BENCH_SIZE;
+	for (std::size_t n = BENCH_SIZE; n <= 100 * std::size_t{BENCH_SIZE};
+		 n *= 10) {
+		auto keys = random_keys(n);
+		std::cout << " " << n << " elements" << std::endl;
+		if (n <= chained_limit)
+			bench_compact_set<structures::HashTable<int>>("HashTable", keys);
+		bench_compact_set<structures::FlatHashTable<int>>(
+			"FlatHashTable", keys);
+		bench_compact_set<structures::RobinHoodHashTable<int>>(
+			"RobinHoodHashTable", keys);
+		bench_compact_set<structures::CuckooHashTable<int>>(
+			"CuckooHashTable", keys);
+	}
+}
+
+// a key followed by a payload, `Size` bytes in total
+template <std::size_t Size>
+struct Record {
+	std::uint64_t key;
+	char payload[Size - sizeof(std::uint64_t)];
+
+	bool operator<(const Record& other) const { return key < other.key; }
+};
+
+template <typename T, std::size_t Arity>
+void bench_heap(const std::vector<T>& items) {
+	structures::HeapWrapper<T, std::less<T>, Arity> heap;
+	double push = time_ms([&] {
+		for (auto& item : items)
+			heap.push(item);
+	});
+	bool sorted = true;
+	double pop = time_ms([&] {
+		std::uint64_t previous = ~std::uint64_t{0};
+		while (heap.size() > 0) {
+			std::uint64_t key = heap.pop().key;
+			sorted &= key <= previous;
+			previous = key;
+		}
+	});
+	std::cout << "  arity " << Arity << ": push " << push * 1e6 / items.size()
+			  << " ns, pop " << pop * 1e6 / items.size() << " ns" << std::endl;
+	if (!sorted)
+		std::cout << "  wrong results!" << std::endl;
+}
+
+template <std::size_t Size>
+void bench_heap_arities() {
+	std::vector<Record<Size>> items(BENCH_SIZE);
+	std::mt19937_64 rng{42};
+	for (auto& item : items)
+		item.key = rng();
+	std::cout << " " << BENCH_SIZE << " elements of " << Size << " bytes"
+			  << std::endl;
+	bench_heap<Record<Size>, 2>(items);
+	bench_heap<Record<Size>, 4>(items);
+	bench_heap<Record<Size>, 8>(items);
+}
+
+void heap_throughput() {
+	bench_heap_arities<16>();
+	bench_heap_arities<64>();
+	bench_heap_arities<256>();
+}
+
+template <std::size_t Size>
+struct Payload {
+	char bytes[Size];
+};
+
+// pushes then pops `n` records with a `Size` bytes payload, in a Heap of
+// whole records and in a KeyValueHeap
+template <std::size_t Size>
+void bench_split_heap(std::size_t n) {
+	using Whole = Record<Size + sizeof(std::uint64_t)>;
+	std::vector<Whole> items(n);
+	std::mt19937_64 rng{42};
+	for (auto& item : items)
+		item.key = rng();
+	std::cout << " " << n << " elements with " << Size << " bytes payloads"
+			  << std::endl;
+
+	structures::Heap<Whole> whole;
+	double push = time_ms([&] {
+		for (auto& item : items)
+			whole.push(item);
+	});
+	std::uint64_t whole_keys = 0, split_keys = 0;
+	double pop = time_ms([&] {
+		while (whole.size() > 0)
+			whole_keys = whole_keys * 31 + whole.pop().key;
+	});
+	std::cout << "  Heap: push " << push * 1e6 / n << " ns, pop "
+			  << pop * 1e6 / n << " ns" << std::endl;
+
+	structures::KeyValueHeap<std::uint64_t, Payload<Size>> split;
+	push = time_ms([&] {
+		for (auto& item : items) {
+			Payload<Size> payload;
+			std::memcpy(payload.bytes, item.payload, Size);
+			split.push(item.key, payload);
+		}
+	});
+	pop = time_ms([&] {
+		while (split.size() > 0)
+			split_keys = split_keys * 31 + split.pop().first;
+	});
+	std::cout << "  KeyValueHeap: push " << push * 1e6 / n << " ns, pop "
+			  << pop * 1e6 / n << " ns" << std::endl;
+	if (whole_keys != split_keys)
+		std::cout << "  wrong results!" << std::endl;
+}
+
+void split_heaps() {
+	bench_split_heap<128>(BENCH_SIZE);
+	bench_split_heap<512>(BENCH_SIZE / 4);
+}
+
+void bench_heap_construction(
+	const std::string& name, const std::vector<std::uint64_t>& keys) {
+	std::size_t n = keys.size();
+	std::uint64_t largest = *std::max_element(keys.begin(), keys.end());
+	std::cout << " " << n << " " << name << " keys" << std::endl;
+
+	using Heap = structures::Heap<std::uint64_t>;
+	double ms = time_ms([&] {
+		Heap heap;
+		for (auto key : keys)
+			heap.push(key);
+		if (heap.top() != largest)
+			std::cout << "  wrong results!" << std::endl;
+	});
+	std::cout << "  n pushes: " << ms << " ms" << std::endl;
+
+	Heap heap;
+	ms = time_ms([&] { heap = Heap{keys.begin(), keys.end()}; });
+	std::cout << "  from a range: " << ms << " ms" << std::endl;
+
+	Heap half{keys.begin(), keys.begin() + n / 2};
+	Heap other{keys.begin() + n / 2, keys.end()};
+	ms = time_ms([&] { half.merge(other); });
+	std::cout << "  merge of two halves: " << ms << " ms" << std::endl;
+
+	std::vector<std::uint64_t> top;
+	ms = time_ms([&] { heap.pop_n(100, std::back_inserter(top)); });
+	std::cout << "  pop_n(100): " << ms << " ms" << std::endl;
+	if (half.top() != largest || top[0] != largest ||
+		!std::is_sorted(top.rbegin(), top.rend()))
+		std::cout << "  wrong results!" << std::endl;
+}
+
+void heap_construction() {
+	std::vector<std::uint64_t> keys(10 * BENCH_SIZE);
+	std::mt19937_64 rng{42};
+	for (auto& key : keys)
+		key = rng();
+	bench_heap_construction("random", keys);
+	// every push moves the new key up to the top
+	std::sort(keys.begin(), keys.end());
+	bench_heap_construction("ascending", keys);
+}
+
+// a Heap behind a mutex, with the interface of ConcurrentPriorityQueue
+struct LockedHeap {
+	explicit LockedHeap(std::size_t) {}
+
+	void push(std::uint64_t key) {
+		std::lock_guard<std::mutex> lock{mutex};
+		heap.push(key);
+	}
+
+	bool try_pop(std::uint64_t& out) {
+		std::lock_guard<std::mutex> lock{mutex};
+		if (heap.size() == 0)
+			return false;
+		out = heap.pop();
+		return true;
+	}
+
+	std::mutex mutex;
+	structures::Heap<std::uint64_t> heap;
+};
+
+// millions of operations per second of `threads` threads that alternate
+// pushes of random keys and pops
+template <typename Q>
+double queue_throughput(std::size_t threads) {
+	Q queue{threads};
+	std::mt19937_64 rng{42};
+	for (std::size_t i = 0; i < BENCH_SIZE; i++)
+		queue.push(rng());
+
+	const std::size_t ops = BENCH_SIZE / 4;
+	double ms = time_ms([&] {
+		std::vector<std::thread> workers;
+		for (std::size_t id = 0; id < threads; id++) {
+			workers.emplace_back([&queue, id, ops] {
+				std::mt19937_64 rng{id};
+				std::uint64_t key;
+				for (std::size_t i = 0; i < ops; i += 2) {
+					queue.push(rng());
+					queue.try_pop(key);
+				}
+			});
+		}
+		for (auto& w : workers)
+			w.join();
+	});
+	return threads * ops / ms / 1e3;
+}
+
+// mean and largest rank of the popped keys among the keys in the queue, 0
+// being the largest one, when a tenth of a random permutation is popped
+void report_rank_error(std::size_t threads) {
+	const std::size_t n = BENCH_SIZE;
+	std::vector<std::uint64_t> keys(n);
+	for (std::size_t i = 0; i < n; i++)
+		keys[i] = i;
+	std::shuffle(keys.begin(), keys.end(), std::mt19937_64{42});
+	structures::ConcurrentPriorityQueue<std::uint64_t> queue{threads};
+	for (auto key : keys)
+		queue.push(key);
+
+	// a Fenwick tree of the keys still in the queue
+	std::vector<std::size_t> tree(n + 1);
+	auto add = [&](std::size_t key, std::size_t value) {
+		for (std::size_t i = key + 1; i <= n; i += i & -i)
+			tree[i] += value;
+	};
+	auto smaller = [&](std::size_t key) {
+		std::size_t count = 0;
+		for (std::size_t i = key; i > 0; i -= i & -i)
+			count += tree[i];
+		return count;
+	};
+	for (std::size_t key = 0; key < n; key++)
+		add(key, 1);
+
+	double total = 0;
+	std::size_t largest = 0;
+	for (std::size_t i = 0; i < n / 10; i++) {
+		std::uint64_t key;
+		queue.try_pop(key);
+		std::size_t rank = n - i - 1 - smaller(key);
+		add(key, -1);
+		total += rank;
+		largest = std::max(largest, rank);
+	}
+	std::cout << "  " << queue.queues_count() << " heaps (" << threads
+			  << " threads): mean rank error " << total / (n / 10)
+			  << ", max " << largest << std::endl;
+}
+
+void concurrent_priority_queues() {
+	std::cout << "  Heap + mutex:";
+	for (std::size_t threads = 1; threads <= 32; threads *= 2)
+		std::cout << " " << threads << "T "
+				  << queue_throughput<LockedHeap>(threads);
+	std::cout << " Mops/s" << std::endl;
+
+	std::cout << "  ConcurrentPriorityQueue:";
+	for (std::size_t threads = 1; threads <= 32; threads *= 2)
+		std::cout << " " << threads << "T "
+				  << queue_throughput<structures::ConcurrentPriorityQueue<
+						 std::uint64_t>>(threads);
+	std::cout << " Mops/s" << std::endl;
+
+	for (std::size_t threads = 1; threads <= 32; threads *= 2)
+		report_rank_error(threads);
+}
+
+// a random sparse directed graph in compressed rows: the edges of vertex v
+// are [offsets[v], offsets[v + 1])
+struct Graph {
+	std::vector<std::uint32_t> offsets, targets, weights;
+};
+
+Graph random_graph(std::uint32_t vertices, std::uint32_t degree) {
+	Graph g;
+	std::mt19937 rng{42};
+	for (std::uint32_t v = 0; v < vertices; v++) {
+		g.offsets.push_back(g.targets.size());
+		for (std::uint32_t e = 0; e < degree; e++) {
+			g.targets.push_back(rng() % vertices);
+			g.weights.push_back(1 + rng() % 1000);
+		}
+	}
+	g.offsets.push_back(g.targets.size());
+	return g;
+}
+
+using Distance = std::pair<std::uint64_t, std::uint32_t>;
+constexpr std::uint64_t unreachable = ~std::uint64_t{0};
+
+// pushes a new copy of a vertex whenever its distance gets shorter, and
+// skips the stale copies when they are popped
+std::vector<std::uint64_t> lazy_dijkstra(const Graph& g, std::size_t& peak) {
+	std::vector<std::uint64_t> dist(g.offsets.size() - 1, unreachable);
+	structures::HeapWrapper<Distance, std::greater<Distance>> heap;
+	dist[0] = 0;
+	heap.push({0, 0});
+	while (heap.size() > 0) {
+		peak = std::max(peak, heap.size());
+		auto [d, v] = heap.pop();
+		if (d > dist[v])
+			continue;
+		for (auto e = g.offsets[v]; e < g.offsets[v + 1]; e++) {
+			std::uint64_t nd = d + g.weights[e];
+			if (nd < dist[g.targets[e]]) {
+				dist[g.targets[e]] = nd;
+				heap.push({nd, g.targets[e]});
+			}
+		}
+	}
+	return dist;
+}
+
+// keeps one entry per vertex and moves it up when its distance gets shorter
+std::vector<std::uint64_t> addressable_dijkstra(
+	const Graph& g, std::size_t& peak) {
+	using Heap =
+		structures::AddressableHeapWrapper<Distance, std::greater<Distance>>;
+	std::vector<std::uint64_t> dist(g.offsets.size() - 1, unreachable);
+	std::vector<Heap::Handle> handles(dist.size());
+	std::vector<bool> done(dist.size());
+	Heap heap;
+	dist[0] = 0;
+	handles[0] = heap.push({0, 0});
+	while (heap.size() > 0) {
+		peak = std::max(peak, heap.size());
+		auto [d, v] = heap.pop();
+		done[v] = true;
+		for (auto e = g.offsets[v]; e < g.offsets[v + 1]; e++) {
+			std::uint32_t u = g.targets[e];
+			std::uint64_t nd = d + g.weights[e];
+			if (nd >= dist[u] || done[u])
+				continue;
+			if (dist[u] == unreachable)
+				handles[u] = heap.push({nd, u});
+			else
+				heap.decrease_key(handles[u], {nd, u});
+			dist[u] = nd;
+		}
+	}
+	return dist;
+}
+
+// returns the distances, compared with `expected` unless it is empty
+template <typename F>
+std::vector<std::uint64_t> bench_dijkstra(
+	const std::string& name, const Graph& g, F&& dijkstra,
+	const std::vector<std::uint64_t>& expected) {
+	std::size_t peak = 0;
+	std::vector<std::uint64_t> dist;
+	double ms = time_ms([&] { dist = dijkstra(g, peak); });
+	std::cout << "  " << name << ": " << ms << " ms, peak heap size " << peak
+			  << std::endl;
+	if (!expected.empty() && dist != expected)
+		std::cout << "  wrong results!" << std::endl;
+	return dist;
+}
+
+void shortest_paths() {
+	for (std::uint32_t degree : {4, 16}) {
+		Graph g = random_graph(BENCH_SIZE, degree);
+		std::cout << " " << BENCH_SIZE << " vertices, " << g.targets.size()
+				  << " edges" << std::endl;
+		auto expected = bench_dijkstra("lazy deletion", g, lazy_dijkstra, {});
+		bench_dijkstra("decrease_key", g, addressable_dijkstra, expected);
+	}
+}
+
+// the lazy deletion Dijkstra, on any min priority queue of Distance
+template <typename Q>
+std::vector<std::uint64_t> monotone_dijkstra(
+	const Graph& g, std::size_t& peak) {
+	std::vector<std::uint64_t> dist(g.offsets.size() - 1, unreachable);
+	Q queue;
+	dist[0] = 0;
+	queue.push({0, 0});
+	while (queue.size() > 0) {
+		peak = std::max(peak, queue.size());
+		auto [d, v] = queue.pop();
+		if (d > dist[v])
+			continue;
+		for (auto e = g.offsets[v]; e < g.offsets[v + 1]; e++) {
+			std::uint64_t nd = d + g.weights[e];
+			if (nd < dist[g.targets[e]]) {
+				dist[g.targets[e]] = nd;
+				queue.push({nd, g.targets[e]});
+			}
+		}
+	}
+	return dist;
+}
+
+// a discrete event simulation: every event schedules one a little later
+template <typename Q>
+void bench_events(const std::string& name) {
+	const std::size_t pending = BENCH_SIZE / 10, events = 10 * BENCH_SIZE;
+	std::mt19937_64 rng{42};
+	Q queue;
+	for (std::size_t i = 0; i < pending; i++)
+		queue.push({rng() % 1000000, static_cast<std::uint32_t>(i)});
+	std::uint64_t previous = 0;
+	bool sorted = true;
+	double ms = time_ms([&] {
+		for (std::size_t i = 0; i < events; i++) {
+			auto [time, id] = queue.pop();
+			sorted &= time >= previous;
+			previous = time;
+			queue.push({time + 1 + rng() % 1000000, id});
+		}
+	});
+	std::cout << "  " << name << ": " << ms * 1e6 / events << " ns per event"
+			  << std::endl;
+	if (!sorted)
+		std::cout << "  wrong results!" << std::endl;
+}
+
+void monotone_heaps() {
+	using Heap = structures::HeapWrapper<Distance, std::greater<Distance>>;
+	using Radix = structures::RadixHeap<std::uint64_t, std::uint32_t>;
+
+	std::cout << " " << BENCH_SIZE / 10 << " pending events" << std::endl;
+	bench_events<Heap>("Heap");
+	bench_events<Radix>("RadixHeap");
+
+	Graph g = random_graph(BENCH_SIZE, 4);
+	std::cout << " Dijkstra, " << BENCH_SIZE << " vertices, "
+			  << g.targets.size() << " edges" << std::endl;
+	auto expected = bench_dijkstra("Heap", g, monotone_dijkstra<Heap>, {});
+	bench_dijkstra("RadixHeap", g, monotone_dijkstra<Radix>, expected);
+}
+
+// the k larger keys of a stream, in a max Heap and a min Heap, with a
+// HashTable of the keys evicted from the min Heap still in the max one
+struct TwoHeaps {
+	explicit TwoHeaps(std::size_t capacity) : capacity{capacity} {}
+
+	void push(std::uint64_t key) {
+		if (low.size() == capacity && key <= low.top())
+			return;
+		high.push(key);
+		low.push(key);
+		if (low.size() > capacity)
+			evicted.insert(low.pop());
+	}
+
+	std::uint64_t min() const { return low.top(); }
+
+	std::uint64_t max() {
+		while (evicted.remove(high.top()))
+			high.pop();
+		return high.top();
+	}
+
+	std::size_t memory_usage() const {
+		return (high.size() + low.size()) * sizeof(std::uint64_t) +
+			   evicted.memory_usage();
+	}
+
+	std::size_t capacity;
+	structures::Heap<std::uint64_t> high;
+	structures::HeapWrapper<std::uint64_t, std::greater<std::uint64_t>> low;
+	structures::HashTable<std::uint64_t> evicted;
+};
+
+// keeps the k larger keys of a stream, reading both ends after every key
+template <typename Q>
+void bench_bounded(
+	const std::string& name, const std::vector<std::uint64_t>& keys,
+	std::size_t k) {
+	Q queue{k};
+	std::uint64_t checksum = 0;
+	double ms = time_ms([&] {
+		for (auto key : keys) {
+			queue.push(key);
+			checksum += queue.max() - queue.min();
+		}
+	});
+	std::cout << "  " << name << ": " << ms * 1e6 / keys.size()
+			  << " ns per key (" << checksum % 1000 << ")";
+	if constexpr (std::is_same<Q, TwoHeaps>::value)
+		std::cout << ", " << queue.memory_usage() << " bytes";
+	else
+		std::cout << ", " << queue.size() * sizeof(std::uint64_t)
+				  << " bytes";
+	std::cout << std::endl;
+}
+
+void double_ended_heaps() {
+	std::vector<std::uint64_t> keys(10 * BENCH_SIZE);
+	std::mt19937_64 rng{42};
+	// a slowly rising stream, so that the top k keep changing
+	for (std::size_t i = 0; i < keys.size(); i++)
+		keys[i] = i + rng() % (BENCH_SIZE / 10);
+	for (std::size_t k : {100, 10000}) {
+		std::cout << " k = " << k << ", " << keys.size() << " keys"
+				  << std::endl;
+		bench_bounded<TwoHeaps>("two Heaps + HashTable", keys, k);
+		bench_bounded<structures::MinMaxHeap<std::uint64_t>>(
+			"bounded MinMaxHeap", keys, k);
+	}
+}
+
+void bench_top_k(const std::vector<std::uint64_t>& keys, std::size_t k) {
+	std::vector<std::uint64_t> full_top, top;
+	double full = time_ms([&] {
+		structures::Heap<std::uint64_t> heap{keys.begin(), keys.end()};
+		heap.pop_n(k, std::back_inserter(full_top));
+	});
+	double bounded = time_ms([&] {
+		structures::TopK<std::uint64_t> top_k{k};
+		for (auto key : keys)
+			top_k.push(key);
+		auto items = top_k.items();
+		for (std::size_t i = 0; i < items.size(); i++)
+			top.push_back(items[i]);
+	});
+	std::cout << "  k = " << k << ": full Heap " << full << " ms, TopK "
+			  << bounded << " ms" << std::endl;
+	if (top != full_top)
+		std::cout << "  wrong results!" << std::endl;
+}
+
+// merges `k` sorted lists with KWayMerge, and with a Heap of the current
+// element of every list
+void bench_merge(const std::vector<std::uint64_t>& keys, std::size_t k) {
+	std::vector<structures::ArrayList<std::uint64_t>> lists(k);
+	std::vector<std::uint64_t> sorted{keys};
+	std::sort(sorted.begin(), sorted.end());
+	for (std::size_t i = 0; i < sorted.size(); i++)
+		lists[keys[i] % k].push_back(sorted[i]);
+
+	// filled once, so that neither run pays for the first touch of its pages
+	std::vector<std::uint64_t> out(keys.size());
+	out.clear();
+	double tree = time_ms([&] {
+		structures::KWayMerge<std::uint64_t> merge;
+		for (auto& list : lists)
+			merge.add(list);
+		merge.merge(std::back_inserter(out));
+	});
+	bool correct = out == sorted;
+
+	using Cursor = std::pair<std::uint64_t, std::size_t>;
+	out.clear();
+	double heap = time_ms([&] {
+		std::vector<std::size_t> next(k, 1);
+		structures::HeapWrapper<Cursor, std::greater<Cursor>> cursors;
+		for (std::size_t i = 0; i < k; i++)
+			if (lists[i].size() > 0)
+				cursors.push({lists[i][0], i});
+		while (cursors.size() > 0) {
+			auto [key, i] = cursors.top();
+			out.push_back(key);
+			if (next[i] < lists[i].size())
+				cursors.replace_top({lists[i][next[i]++], i});
+			else
+				cursors.pop();
+		}
+	});
+	correct &= out == sorted;
+	std::cout << "  " << k << " lists: Heap " << heap << " ms, KWayMerge "
+			  << tree << " ms" << std::endl;
+	if (!correct)
+		std::cout << "  wrong results!" << std::endl;
+}
+
+void top_k_and_merge() {
+	std::vector<std::uint64_t> keys(10 * BENCH_SIZE);
+	std::mt19937_64 rng{42};
+	for (auto& key : keys)
+		key = rng();
+	std::cout << " top k of " << keys.size() << " keys" << std::endl;
+	bench_top_k(keys, 100);
+	bench_top_k(keys, 10000);
+	std::cout << " merge of " << keys.size() << " keys" << std::endl;
+	for (std::size_t k : {16, 256, 4096})
+		bench_merge(keys, k);
+}
+
+// sorts and queues 4 times as many keys as fit in the memory budget
+void external_memory() {
+	const std::size_t budget = BENCH_SIZE * sizeof(std::uint64_t);
+	const std::size_t buffer = std::size_t{256} << 10;
+	std::vector<std::uint64_t> keys(4 * BENCH_SIZE);
+	std::mt19937_64 rng{42};
+	for (auto& key : keys)
+		key = rng();
+	std::cout << " " << keys.size() << " keys, a budget of " << budget / 1e6
+			  << " MB" << std::endl;
+
+	std::vector<std::uint64_t> sorted{keys};
+	double ms = time_ms([&] { std::sort(sorted.begin(), sorted.end()); });
+	std::cout << "  std::sort in memory: " << ms << " ms" << std::endl;
+
+	std::size_t runs = 0;
+	bool correct = true;
+	ms = time_ms([&] {
+		structures::ExternalSorter<std::uint64_t> sorter{budget, buffer};
+		for (auto key : keys)
+			sorter.push(key);
+		std::uint64_t key;
+		for (std::size_t i = 0; sorter.next(key); i++)
+			correct &= key == sorted[i];
+		runs = sorter.runs_written();
+	});
+	std::cout << "  ExternalSorter: " << ms << " ms, " << runs << " runs"
+			  << std::endl;
+
+	ms = time_ms([&] {
+		structures::Heap<std::uint64_t> heap;
+		for (auto key : keys)
+			heap.push(key);
+		for (std::size_t i = keys.size(); i > 0; i--)
+			correct &= heap.pop() == sorted[i - 1];
+	});
+	std::cout << "  Heap in memory, push and pop all: " << ms << " ms"
+			  << std::endl;
+
+	ms = time_ms([&] {
+		structures::ExternalPriorityQueue<std::uint64_t> queue{budget, buffer};
+		for (auto key : keys)
+			queue.push(key);
+		for (std::size_t i = keys.size(); i > 0; i--)
+			correct &= queue.pop() == sorted[i - 1];
+		runs = queue.runs_written();
+	});
+	std::cout << "  ExternalPriorityQueue, push and pop all: " << ms
+			  << " ms, " << runs << " runs" << std::endl;
+	if (!correct)
+		std::cout << "  wrong results!" << std::endl;
+}
+
+// timers in a Heap of deadlines, cancelled by marking their id and
+// skipping them when they reach the top
+struct HeapTimers {
+	explicit HeapTimers(std::size_t n) : cancelled(n) {}
+
+	void schedule(std::uint64_t delay, std::uint32_t id) {
+		heap.push({now + delay, id});
+	}
+
+	void cancel(std::uint32_t id) { cancelled[id] = true; }
+
+	template <typename F>
+	void advance(std::uint64_t elapsed, F expire) {
+		now += elapsed;
+		while (heap.size() > 0 && heap.top().first <= now) {
+			auto id = heap.pop().second;
+			if (!cancelled[id])
+				expire(id);
+		}
+	}
+
+	structures::HeapWrapper<Distance, std::greater<Distance>> heap;
+	std::vector<bool> cancelled;
+	std::uint64_t now{0};
+};
+
+struct AddressableHeapTimers {
+	explicit AddressableHeapTimers(std::size_t n) : handles(n) {}
+
+	void schedule(std::uint64_t delay, std::uint32_t id) {
+		handles[id] = heap.push({now + delay, id});
+	}
+
+	void cancel(std::uint32_t id) { heap.erase(handles[id]); }
+
+	template <typename F>
+	void advance(std::uint64_t elapsed, F expire) {
+		now += elapsed;
+		while (heap.size() > 0 && heap.top().first <= now)
+			expire(heap.pop().second);
+	}
+
+	structures::AddressableHeapWrapper<Distance, std::greater<Distance>> heap;
+	std::vector<std::size_t> handles;
+	std::uint64_t now{0};
+};
+
+struct WheelTimers {
+	explicit WheelTimers(std::size_t n) : handles(n) {}
+
+	void schedule(std::uint64_t delay, std::uint32_t id) {
+		handles[id] = wheel.schedule(delay, id);
+	}
+
+	void cancel(std::uint32_t id) { wheel.cancel(handles[id]); }
+
+	template <typename F>
+	void advance(std::uint64_t elapsed, F expire) {
+		wheel.advance(elapsed, expire);
+	}
+
+	structures::TimingWheel<std::uint32_t> wheel{1, 1000000};
+	std::vector<std::size_t> handles;
+};
+
+// schedules a timer per delay, cancels the timers in `cancels`, and lets
+// time pass until the others expire
+template <typename Q>
+std::uint64_t bench_timers(
+	const std::string& name, const std::vector<std::uint64_t>& delays,
+	const std::vector<std::uint32_t>& cancels) {
+	const std::size_t n = delays.size();
+	Q timers{n};
+	double schedule = time_ms([&] {
+		for (std::size_t i = 0; i < n; i++)
+			timers.schedule(delays[i], i);
+	});
+	double cancel = time_ms([&] {
+		for (auto id : cancels)
+			timers.cancel(id);
+	});
+	// the ids weighted by the step they expired in
+	std::uint64_t checksum = 0;
+	std::size_t expired = 0;
+	double expire = time_ms([&] {
+		for (std::uint64_t time = 0; time <= 1000000; time += 100) {
+			timers.advance(100, [&](std::uint32_t id) {
+				checksum += (id + 1) * time;
+				expired++;
+			});
+		}
+	});
+	std::cout << "  " << name << ": schedule " << schedule * 1e6 / n
+			  << " ns, cancel " << cancel * 1e6 / cancels.size()
+			  << " ns, expire " << expire * 1e6 / expired << " ns"
+			  << std::endl;
+	return checksum;
+}
+
+// delays of up to a million ticks, and half of the timers cancelled
+void timing_wheels() {
+	for (std::size_t n : {BENCH_SIZE, 10 * BENCH_SIZE}) {
+		std::vector<std::uint64_t> delays(n);
+		std::mt19937_64 rng{42};
+		for (auto& delay : delays)
+			delay = 1 + rng() % 1000000;
+		std::vector<std::uint32_t> cancels(n);
+		for (std::size_t i = 0; i < n; i++)
+			cancels[i] = i;
+		std::shuffle(cancels.begin(), cancels.end(), rng);
+		cancels.resize(n / 2);
+
+		std::cout << " " << n << " timers" << std::endl;
+		auto expected = bench_timers<HeapTimers>(
+			"Heap, cancelled lazily", delays, cancels);
+		bool correct = expected == bench_timers<AddressableHeapTimers>(
+									   "AddressableHeap", delays, cancels);
+		correct &= expected ==
+			bench_timers<WheelTimers>("TimingWheel", delays, cancels);
+		if (!correct)
+			std::cout << "  wrong results!" << std::endl;
+	}
+}
+
+struct Benchmark {
+	const char* name;
+	void (*run)();
+};
+
+const Benchmark benchmarks[] = {
+	{"tree_set_operations", tree_set_operations},
+	{"ordered_sets", ordered_sets},
+	{"frozen_sets", frozen_sets},
+	{"tree_turnover", tree_turnover},
+	{"concurrent_sets", concurrent_sets},
+	{"concurrent_hash_sets", concurrent_hash_sets},
+	{"hash_sets", hash_sets},
+	{"hash_resize_latency", hash_resize_latency},
+	{"hash_map_lookups", hash_map_lookups},
+	{"string_hash_sets", string_hash_sets},
+	{"batched_operations", batched_operations},
+	{"perfect_hash_sets", perfect_hash_sets},
+	{"filtered_sets", filtered_sets},
+	{"hash_functions", hash_functions},
+	{"compact_hash_sets", compact_hash_sets},
+	{"heap_throughput", heap_throughput},
+	{"split_heaps", split_heaps},
+	{"heap_construction", heap_construction},
+	{"shortest_paths", shortest_paths},
+	{"monotone_heaps", monotone_heaps},
+	{"double_ended_heaps", double_ended_heaps},
+	{"top_k_and_merge", top_k_and_merge},
+	{"external_memory", external_memory},
+	{"timing_wheels", timing_wheels},
+	{"concurrent_priority_queues", concurrent_priority_queues},
+};
+
+}  // namespace
+
+/*
+ * Runs every benchmark, or only the ones whose name contains the first
+ * argument. The amount of elements is set by BENCH_SIZE at compile time.
+ */
+int main(int argc, char** argv) {
+	for (auto& b : benchmarks) {
+		if (argc < 2 || std::strstr(b.name, argv[1])) {
+			std::cout << "== " << b.name << std::endl;
+			b.run();
+		}
+	}
+}
@@ -2,21 +2,68 @@
 
 #include "tests.h"
 
+#include <addressable_heap.h>
 #include <array_list.h>
 #include <avl_tree.h>
+#include <b_plus_tree.h>
 #include <binary_tree.h>
+#include <concurrent_avl_tree.h>
+#include <concurrent_hash_table.h>
+#include <concurrent_priority_queue.h>
+#include <cuckoo_hash_table.h>
 #include <doubly_circular_list.h>
+#include <external_priority_queue.h>
+#include <external_sort.h>
+#include <filtered_set.h>
+#include <flat_hash_table.h>
+#include <hash.h>
+#include <hash_map.h>
 #include <hash_table.h>
 #include <heap.h>
+#include <k_way_merge.h>
+#include <key_value_heap.h>
 #include <linked_list.h>
+#include <min_max_heap.h>
 #include <queue.h>
+#include <radix_heap.h>
 #include <rb_tree.h>
+#include <robin_hood_hash_table.h>
 #include <stack.h>
+#include <timing_wheel.h>
+#include <top_k.h>
 
 int main() {
 	tests::test_structures<
 		structures::ArrayList, structures::LinkedList,
 		structures::DoublyCircularList, structures::Stack, structures::Queue,
 		structures::BinaryTree, structures::AVLTree, structures::RBTree,
-		structures::HashTable, structures::Heap>();
+		structures::BPlusTree, structures::ConcurrentAVLTree,
+		structures::HashTable, structures::CachedHashTable,
+		structures::FlatHashTable, structures::RobinHoodHashTable,
+		structures::CuckooHashTable, structures::ConcurrentHashTable,
+		structures::Heap, structures::AddressableHeap,
+		structures::ConcurrentPriorityQueue, structures::MinMaxHeap,
+		structures::TopK, structures::KWayMerge, structures::ExternalSorter,
+		structures::ExternalPriorityQueue, structures::TimingWheel>();
+
+	std::cout << "testing HashMap... ";
+	tests::test_hash_map();
+	std::cout << "OK" << std::endl;
+
+	std::cout << "testing RadixHeap... ";
+	tests::test_radix_heap();
+	std::cout << "OK" << std::endl;
+
+	std::cout << "testing KeyValueHeap... ";
+	tests::test_key_value_heap();
+	std::cout << "OK" << std::endl;
+
+	std::cout << "testing hash functions... ";
+	tests::test_hashers();
+	std::cout << "OK" << std::endl;
+
+	std::cout << "testing FilteredSet... ";
+	tests::test_filtered_set<structures::HashTable, structures::BloomFilter>();
+	tests::test_filtered_set<structures::RBTree, structures::CuckooFilter>();
+	std::cout << "OK" << std::endl;
 }
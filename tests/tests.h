@@ -2,15 +2,46 @@
 #define TESTS_H
 
 #include <assert.h>
+#include <cstdint>
 #include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
 #include <type_traits>
 #include <typeinfo>
 #include <vector>
 
+#if defined(__unix__)
+#include <sys/resource.h>
+#endif
+
+#include <addressable_heap.h>
+#include <array_list.h>
+#include <b_plus_tree.h>
+#include <concurrent_avl_tree.h>
+#include <concurrent_hash_table.h>
+#include <concurrent_priority_queue.h>
+#include <external_priority_queue.h>
+#include <external_sort.h>
+#include <filtered_set.h>
+#include <hash.h>
+#include <hash_map.h>
+#include <hash_table.h>
 #include <heap.h>
+#include <k_way_merge.h>
+#include <key_value_heap.h>
+#include <min_max_heap.h>
+#include <perfect_hash_set.h>
 #include <queue.h>
+#include <radix_heap.h>
 #include <stack.h>
+#include <timing_wheel.h>
+#include <top_k.h>
 #include <traits.h>
+#include <tree.h>
 
 namespace tests {
 
@@ -117,9 +148,312 @@ typename std::enable_if_t<traits::is_set<S>::value> test_structure_wrapper() {
 	}
 }
 
+template <template <typename> class S>
+void test_tree_operations() {
+	structures::ArrayList<int> evens, threes;
+	for (int i = 0; i < 4 * SIZE; i++) {
+		if (i % 2 == 0)
+			evens.push_back(i);
+		if (i % 3 == 0)
+			threes.push_back(i);
+	}
+
+	S<int> a, b;
+	a.assign_sorted(evens);
+	b.assign_sorted(threes);
+	assert(a.size() == evens.size());
+	assert(b.size() == threes.size());
+
+	// splits the work between threads even on a single core
+	auto threads = structures::fork_join::threads();
+	structures::fork_join::threads() = 4;
+	auto u = structures::set_union(a, b);
+	auto n = structures::set_intersection(a, b);
+	auto d = structures::set_difference(a, b);
+	structures::fork_join::threads() = threads;
+
+	for (int i = 0; i < 4 * SIZE; i++) {
+		assert(a.contains(i) == (i % 2 == 0));
+		assert(u.contains(i) == (i % 2 == 0 || i % 3 == 0));
+		assert(n.contains(i) == (i % 6 == 0));
+		assert(d.contains(i) == (i % 2 == 0 && i % 3 != 0));
+	}
+
+	auto frozen = u.freeze();
+	auto blocked = u.template freeze<structures::FrozenBlockedSet<int>>();
+	assert(frozen.size() == u.size());
+	assert(blocked.size() == u.size());
+	for (int i = -1; i < 4 * SIZE + 1; i++) {
+		assert(frozen.contains(i) == u.contains(i));
+		assert(blocked.contains(i) == u.contains(i));
+		int next = i + 1;
+		while (next < 4 * SIZE && !u.contains(next))
+			next++;
+		auto lower = frozen.lower_bound(i + 1);
+		assert(lower ? *lower == next : next >= 4 * SIZE);
+		assert(blocked.lower_bound(i + 1) ? *blocked.lower_bound(i + 1) == next
+										  : next >= 4 * SIZE);
+	}
+
+	auto in_order = u.in_order();
+	auto frozen_items = frozen.items();
+	auto blocked_items = blocked.items();
+	assert(frozen_items.size() == in_order.size());
+	assert(blocked_items.size() == in_order.size());
+	assert(in_order.size() == u.size());
+	for (std::size_t i = 1; i < in_order.size(); i++) {
+		assert(in_order[i - 1] < in_order[i]);
+	}
+	for (std::size_t i = 0; i < in_order.size(); i++) {
+		assert(frozen_items[i] == in_order[i]);
+		assert(blocked_items[i] == in_order[i]);
+	}
+
+	// moved-from sets are empty
+	auto moved = std::move(frozen);
+	auto moved_blocked = std::move(blocked);
+	assert(frozen.size() == 0 && !frozen.contains(0));
+	assert(blocked.size() == 0 && !blocked.contains(0));
+	assert(!frozen.lower_bound(0) && !blocked.lower_bound(0));
+	frozen = std::move(moved);
+	blocked = std::move(moved_blocked);
+	assert(frozen.contains(0) && !moved.contains(0));
+	assert(blocked.contains(0) && !moved_blocked.contains(0));
+
+	// a bulk built tree must keep working as a regular one
+	for (int i = 0; i < 4 * SIZE; i++) {
+		assert(u.remove(i) == (i % 2 == 0 || i % 3 == 0));
+		assert(u.insert(-i - 1));
+	}
+	assert(u.size() == 4 * SIZE);
+
+	// copies keep the shape of the tree, which may be degenerate, and set
+	// operations must walk such trees too
+	auto copy = u;
+	structures::fork_join::threads() = 4;
+	assert(structures::set_intersection(u, copy).size() == u.size());
+	structures::fork_join::threads() = threads;
+	for (int i = 0; i < 4 * SIZE; i++) {
+		assert(copy.remove(-i - 1));
+	}
+	assert(copy.size() == 0);
+	assert(u.size() == 4 * SIZE);
+
+	u.clear();
+	assert(u.size() == 0);
+	assert(!u.contains(-1));
+}
+
+/*
+ * Each thread owns the keys that are congruent to its id, so it knows what
+ * every operation must return, while other threads change the same set.
+ * Ordered sets must also list their items in order.
+ */
+template <template <typename> class S, bool ordered = true>
+void test_concurrent_set() {
+	const int threads = 4;
+	S<int> set;
+	std::vector<std::thread> workers;
+
+	for (int id = 0; id < threads; id++) {
+		workers.emplace_back([&set, id] {
+			std::vector<bool> inserted(SIZE / 10);
+			unsigned seed = id + 1;
+			for (int i = 0; i < 10 * SIZE; i++) {
+				seed = seed * 1103515245 + 12345;
+				std::size_t k = (seed >> 8) % inserted.size();
+				int key = static_cast<int>(k) * threads + id;
+				switch ((seed >> 4) % 3) {
+				case 0:
+					assert(set.insert(key) == !inserted[k]);
+					inserted[k] = true;
+					break;
+				case 1:
+					assert(set.remove(key) == inserted[k]);
+					inserted[k] = false;
+					break;
+				default:
+					assert(set.contains(key) == inserted[k]);
+				}
+			}
+		});
+	}
+	for (auto& w : workers)
+		w.join();
+
+	auto items = set.items();
+	assert(items.size() == set.size());
+	if (ordered) {
+		for (std::size_t i = 1; i < items.size(); i++)
+			assert(items[i - 1] < items[i]);
+	} else {
+		for (std::size_t i = 0; i < items.size(); i++)
+			assert(set.contains(items[i]));
+	}
+}
+
+template <typename S, typename = void>
+struct has_batches : std::false_type {};
+
+template <typename S>
+struct has_batches<S, std::void_t<decltype(&S::contains_many)>>
+	: std::true_type {};
+
+/*
+ * The batched operations must agree with the operations on one key.
+ */
+template <template <typename> class S>
+void test_batches() {
+	const int n = SIZE / 10;
+	S<int> set;
+	std::vector<int> keys;
+	for (int i = 0; i < n; i++)
+		keys.push_back((i * 7919) % n * 2);
+
+	assert(set.insert_many(keys.data(), keys.size()) == keys.size());
+	assert(set.insert_many(keys.data(), keys.size() / 2) == 0);
+	assert(set.size() == keys.size());
+
+	std::vector<int> probes;
+	for (int i = -1; i < 2 * n + 1; i++)
+		probes.push_back(i);
+	std::unique_ptr<bool[]> out{new bool[probes.size()]};
+	set.contains_many(probes.data(), probes.size(), out.get());
+	for (std::size_t i = 0; i < probes.size(); i++) {
+		int k = probes[i];
+		assert(out[i] == (k >= 0 && k < 2 * n && k % 2 == 0));
+		assert(out[i] == set.contains(k));
+	}
+}
+
+template <typename S, typename = void>
+struct has_freeze : std::false_type {};
+
+template <typename S>
+struct has_freeze<S, std::void_t<decltype(&S::freeze)>> : std::true_type {};
+
+// a hash whose low 32 bits are always zero
+struct HighBitsHash {
+	using is_avalanching = void;
+
+	std::uint64_t operator()(int x) const {
+		return static_cast<std::uint64_t>(x) << 32;
+	}
+};
+
+/*
+ * Hash sets freeze into a PerfectHashSet, whose elements are not in order.
+ */
+template <template <typename> class S>
+void test_perfect_hash_set() {
+	S<int> set;
+	for (int i = 0; i < SIZE; i++)
+		set.insert(3 * i);
+
+	auto frozen = set.freeze();
+	assert(frozen.size() == SIZE);
+	assert(frozen.items().size() == SIZE);
+	for (int i = -1; i < 3 * SIZE; i++)
+		assert(frozen.contains(i) == (i >= 0 && i % 3 == 0));
+
+	auto copy = frozen;
+	assert(copy.contains(0) && !copy.contains(1));
+	assert(!decltype(frozen){}.contains(0));
+
+	// a moved-from set is empty
+	auto moved = std::move(copy);
+	assert(copy.size() == 0 && !copy.contains(0));
+	copy = std::move(moved);
+	assert(copy.contains(0) && moved.size() == 0 && !moved.contains(0));
+
+	// the same low bits send every key to one oversized bucket, until
+	// another seed remixes the hashes
+	structures::ArrayList<int> keys;
+	for (int i = 0; i < SIZE; i++)
+		keys.push_back(3 * i);
+	structures::PerfectHashSet<int, HighBitsHash> skewed{keys};
+	for (int i = -1; i < 3 * SIZE; i++)
+		assert(skewed.contains(i) == (i >= 0 && i % 3 == 0));
+}
+
 template <template <typename> class S>
 void test_structure() {
 	test_structure_wrapper<S>();
+	if constexpr (traits::is_tree<S>::value)
+		test_tree_operations<S>();
+	if constexpr (has_batches<S<int>>::value)
+		test_batches<S>();
+	if constexpr (has_freeze<S<int>>::value && !traits::is_tree<S>::value)
+		test_perfect_hash_set<S>();
+}
+
+/*
+ * Checks that `range(lo, hi)` of a BPlusTree whose elements are the even
+ * numbers below `end`, except the ones in `removed`, lists them in order.
+ */
+inline void check_ranges(
+	const structures::BPlusTree<int>& tree, int end,
+	const std::vector<bool>& removed) {
+	for (int lo = -3; lo < end + 3; lo += 97) {
+		for (int hi : {lo - 1, lo, lo + 1, lo + 2, lo + 500, end + 10}) {
+			auto range = tree.range(lo, hi);
+			std::size_t k = 0;
+			for (int x = 0; x < end; x += 2)
+				if (lo <= x && x < hi && !removed[x])
+					assert(k < range.size() && range[k++] == x);
+			assert(k == range.size());
+		}
+	}
+}
+
+template <>
+void test_structure<structures::BPlusTree>() {
+	test_structure_wrapper<structures::BPlusTree>();
+
+	structures::BPlusTree<int> tree;
+	assert(tree.range(0, SIZE).size() == 0);
+
+	structures::ArrayList<int> evens;
+	for (int i = 0; i < 2 * SIZE; i += 2)
+		evens.push_back(i);
+	tree.assign_sorted(evens);
+	assert(tree.size() == SIZE);
+
+	// bounds on the elements, between them and outside of the tree, so
+	// that ranges start and end in any leaf and follow the leaf links
+	std::vector<bool> removed(2 * SIZE);
+	check_ranges(tree, 2 * SIZE, removed);
+
+	// a bulk built tree must keep working as a regular one, while leaves
+	// are merged by the removes
+	for (int i = 0; i < 2 * SIZE; i += 4) {
+		assert(tree.remove(i) && !tree.remove(i + 1));
+		removed[i] = true;
+	}
+	assert(tree.size() == SIZE / 2);
+	check_ranges(tree, 2 * SIZE, removed);
+
+	auto items = tree.items();
+	assert(items.size() == SIZE / 2);
+	for (std::size_t i = 0; i < items.size(); i++)
+		assert(items[i] == 4 * static_cast<int>(i) + 2);
+
+	for (int i = 2; i < 2 * SIZE; i += 4)
+		assert(tree.remove(i));
+	assert(tree.size() == 0 && tree.range(-1, 2 * SIZE).size() == 0);
+	assert(tree.insert(7) && tree.range(0, 8).size() == 1);
+}
+
+template <>
+void test_structure<structures::ConcurrentAVLTree>() {
+	test_structure_wrapper<structures::ConcurrentAVLTree>();
+	test_concurrent_set<structures::ConcurrentAVLTree>();
+}
+
+template <>
+void test_structure<structures::ConcurrentHashTable>() {
+	test_structure_wrapper<structures::ConcurrentHashTable>();
+	test_concurrent_set<structures::ConcurrentHashTable, false>();
 }
 
 template <>
@@ -191,6 +525,40 @@ void test_structure<structures::Queue>() {
 	copy = std::move(queue);
 }
 
+template <std::size_t Arity>
+void test_heap_arity() {
+	structures::HeapWrapper<int, std::less<int>, Arity> pq;
+	for (int i = 0; i < SIZE; i++)
+		pq.push((i * 7919) % SIZE);
+
+	for (int i = SIZE - 1; i >= 0; i--) {
+		assert(pq.top() == i);
+		assert(pq.pop() == i);
+	}
+	assert(pq.size() == 0);
+
+	// built from a range, grown by ranges and merged, in halves of SIZE
+	std::vector<int> values;
+	for (int i = 0; i < SIZE; i++)
+		values.push_back((i * 7919) % SIZE);
+	auto middle = values.begin() + SIZE / 2;
+	structures::HeapWrapper<int, std::less<int>, Arity> built{
+		values.begin(), middle};
+	built.push_range(middle, middle + SIZE / 4);
+	structures::HeapWrapper<int, std::less<int>, Arity> rest;
+	rest.push_range(middle + SIZE / 4, values.end());
+	built.merge(rest);
+	assert(built.size() == SIZE && rest.size() == 0);
+
+	std::vector<int> top;
+	built.pop_n(10, std::back_inserter(top));
+	for (int i = 0; i < 10; i++)
+		assert(top[i] == SIZE - 1 - i);
+	for (int i = SIZE - 11; i >= 0; i--)
+		assert(built.pop() == i);
+	assert(built.pop_n(1, top.begin()) == top.begin());
+}
+
 template <>
 void test_structure<structures::Heap>() {
 	structures::Heap<int> pq, copy;
@@ -218,6 +586,499 @@ void test_structure<structures::Heap>() {
 	}
 
 	copy = std::move(pq);
+
+	test_heap_arity<2>();
+	test_heap_arity<3>();
+	test_heap_arity<8>();
+
+	// elements are only moved, so they need not be copyable
+	struct PointeeLess {
+		using Owner = std::unique_ptr<int>;
+
+		bool operator()(const Owner& a, const Owner& b) const {
+			return *a < *b;
+		}
+	};
+	structures::HeapWrapper<std::unique_ptr<int>, PointeeLess> owners;
+	for (int i : v)
+		owners.push(std::make_unique<int>(i));
+	for (int i = 9; i >= 1; i--)
+		assert(*owners.pop() == i);
+
+	// there is no top to replace in an empty heap
+	bool thrown = false;
+	try {
+		owners.replace_top(std::make_unique<int>(0));
+	} catch (const std::out_of_range&) {
+		thrown = true;
+	}
+	assert(thrown && owners.size() == 0);
+}
+
+template <>
+void test_structure<structures::MinMaxHeap>() {
+	structures::MinMaxHeap<int> pq;
+	for (int i = 0; i < SIZE; i++)
+		pq.push((i * 7919) % SIZE);
+
+	// takes from both ends until they meet
+	for (int i = 0; i < SIZE / 2; i++) {
+		assert(pq.min() == i && pq.max() == SIZE - 1 - i);
+		assert(pq.pop_min() == i);
+		assert(pq.pop_max() == SIZE - 1 - i);
+	}
+	assert(pq.size() == 0);
+
+	// keeps the 100 larger elements
+	structures::MinMaxHeap<int> top{100};
+	for (int i = 0; i < SIZE; i++)
+		top.push((i * 7919) % SIZE);
+	assert(top.size() == 100 && top.capacity() == 100);
+	assert(!top.push(0));
+	for (int i = SIZE - 100; i < SIZE; i++)
+		assert(top.pop_min() == i);
+}
+
+template <>
+void test_structure<structures::TopK>() {
+	const int threads = 4;
+	structures::TopK<int> top{100};
+	std::vector<structures::TopK<int>> parts(threads, top);
+	std::vector<std::thread> workers;
+
+	// every thread takes every fourth element of a stream
+	for (int id = 0; id < threads; id++) {
+		workers.emplace_back([&parts, id] {
+			for (int i = id; i < SIZE; i += threads)
+				parts[id].push((i * 7919) % SIZE);
+		});
+	}
+	for (auto& w : workers)
+		w.join();
+
+	for (auto& part : parts)
+		top.merge(part);
+	assert(top.size() == 100 && top.threshold() == SIZE - 100);
+	assert(!top.push(0) && top.push(SIZE));
+
+	auto items = top.items();
+	assert(items[0] == SIZE);
+	for (int i = 1; i < 100; i++)
+		assert(items[i] == SIZE - i);
+}
+
+template <>
+void test_structure<structures::KWayMerge>() {
+	const int k = 13;
+	std::vector<structures::ArrayList<int>> lists(k);
+	for (int i = 0; i < SIZE; i++)
+		lists[(i * 7919) % k].push_back(i);
+
+	structures::KWayMerge<int> merge;
+	std::vector<int> evens, odds;
+	for (int i = 0; i < 2 * SIZE; i += 2) {
+		evens.push_back(i);
+		odds.push_back(i + 1);
+	}
+	for (auto& list : lists)
+		merge.add(list);
+	merge.add(evens.begin(), evens.end());
+	int next = 1;
+	merge.add([&next](int& out) {
+		out = next;
+		next += 2;
+		return out < 2 * SIZE;
+	});
+	assert(merge.size() == k + 2);
+
+	// every number below SIZE three times, then the rest of both halves
+	std::vector<int> out;
+	merge.merge(std::back_inserter(out));
+	assert(out.size() == 3 * SIZE);
+	for (std::size_t i = 1; i < out.size(); i++)
+		assert(out[i - 1] <= out[i]);
+	assert(out[0] == 0 && out[1] == 0 && out[2] == 1 && out[3] == 1);
+	int taken;
+	assert(!merge.next(taken));
+}
+
+template <>
+void test_structure<structures::ExternalSorter>() {
+	// a budget of a few hundred elements, so that SIZE takes many runs and
+	// more than one merge pass
+	structures::ExternalSorter<int> sorter{4096, 512};
+	for (int i = 0; i < SIZE; i++)
+		sorter.push((i * 7919) % SIZE);
+	assert(sorter.size() == SIZE);
+
+	int data;
+	for (int i = 0; i < SIZE; i++) {
+		assert(sorter.next(data));
+		assert(data == i);
+	}
+	assert(!sorter.next(data) && sorter.size() == 0);
+	assert(sorter.runs_written() > 8);
+
+	// fits in memory
+	structures::ExternalSorter<int> small;
+	for (int i = 0; i < 100; i++)
+		small.push(99 - i);
+	for (int i = 0; i < 100; i++)
+		assert(small.next(data) && data == i);
+	assert(small.runs_written() == 0);
+}
+
+template <>
+void test_structure<structures::ExternalPriorityQueue>() {
+	structures::ExternalPriorityQueue<int> pq{4096, 256};
+
+	// pops interleaved with pushes, so that runs are read while written
+	for (int i = 0; i < SIZE; i++) {
+		pq.push((i * 7919) % SIZE);
+		if (i % 4 == 3) {
+			int top = pq.top();
+			assert(pq.pop() == top);
+		}
+	}
+	assert(pq.size() == SIZE - SIZE / 4);
+	assert(pq.runs_written() > 1);
+
+	int previous = SIZE;
+	while (pq.size() > 0) {
+		int top = pq.pop();
+		assert(top <= previous);
+		previous = top;
+	}
+
+#if defined(__unix__)
+	// more runs than the files that may be open, since they share one
+	rlimit limit;
+	getrlimit(RLIMIT_NOFILE, &limit);
+	rlimit lowered = limit;
+	lowered.rlim_cur = 32;
+	setrlimit(RLIMIT_NOFILE, &lowered);
+	{
+		structures::ExternalPriorityQueue<int> many{1024, 4};
+		for (int i = 0; i < SIZE; i++)
+			many.push((i * 7919) % SIZE);
+		assert(many.runs_written() > 32);
+		for (int i = SIZE - 1; i >= 0; i--)
+			assert(many.pop() == i);
+	}
+	setrlimit(RLIMIT_NOFILE, &limit);
+#endif
+}
+
+template <>
+void test_structure<structures::ConcurrentPriorityQueue>() {
+	const int threads = 4;
+	structures::ConcurrentPriorityQueue<int> pq{threads};
+	std::vector<std::vector<int>> popped(threads);
+	std::vector<std::thread> workers;
+
+	// every thread pushes its own keys and pops about half as many
+	for (int id = 0; id < threads; id++) {
+		workers.emplace_back([&pq, &popped, id] {
+			for (int i = 0; i < SIZE; i++) {
+				pq.push(i * threads + id);
+				int top;
+				if (i % 2 && pq.try_pop(top))
+					popped[id].push_back(top);
+			}
+		});
+	}
+	for (auto& w : workers)
+		w.join();
+
+	std::vector<bool> seen(SIZE * threads);
+	int top;
+	while (pq.try_pop(top))
+		popped[0].push_back(top);
+	assert(pq.size() == 0);
+	for (auto& list : popped) {
+		for (int key : list) {
+			assert(!seen[key]);
+			seen[key] = true;
+		}
+	}
+	for (bool b : seen)
+		assert(b);
+}
+
+template <>
+void test_structure<structures::AddressableHeap>() {
+	structures::AddressableHeap<int> pq;
+	std::vector<std::size_t> handles;
+
+	for (int i = 0; i < SIZE; i++)
+		handles.push_back(pq.push(i));
+	for (int i = 0; i < SIZE; i++)
+		assert(pq.value(handles[i]) == i);
+
+	// moves every element: evens up, odds down, then erases a third
+	for (int i = 0; i < SIZE; i++) {
+		if (i % 2)
+			pq.decrease_key(handles[i], -i);
+		else
+			pq.increase_key(handles[i], SIZE + i);
+	}
+	for (int i = 0; i < SIZE; i += 3) {
+		assert(pq.erase(handles[i]) == (i % 2 ? -i : SIZE + i));
+		assert(!pq.contains(handles[i]));
+	}
+	assert(pq.size() == SIZE - (SIZE + 2) / 3);
+
+	int previous = 2 * SIZE;
+	while (pq.size() > 0) {
+		auto handle = pq.top_handle();
+		int top = pq.pop();
+		assert(top <= previous && !pq.contains(handle));
+		previous = top;
+	}
+
+	// handles of removed elements are reused
+	auto handle = pq.push(7);
+	assert(handle < SIZE && pq.contains(handle) && pq.top() == 7);
+	pq.clear();
+	assert(pq.size() == 0 && !pq.contains(handle));
+}
+
+template <>
+void test_structure<structures::TimingWheel>() {
+	const std::uint64_t tick = 10;
+	structures::TimingWheel<int> wheel{tick, 1 << 20};
+	std::vector<std::uint64_t> delays;
+	std::vector<std::size_t> handles;
+
+	for (int i = 0; i < SIZE; i++) {
+		delays.push_back(1 + (i * 7919ull) % (1 << 20));
+		handles.push_back(wheel.schedule(delays[i], i));
+	}
+	for (int i = 0; i < SIZE; i += 3)
+		assert(wheel.cancel(handles[i]) == i && !wheel.contains(handles[i]));
+	assert(wheel.size() == SIZE - (SIZE + 2) / 3);
+
+	// every timer expires at the first tick at or after its deadline, and
+	// the first ones schedule another timer
+	std::vector<bool> expired(SIZE + 100);
+	std::uint64_t previous = 0;
+	auto expire = [&](int i) {
+		std::uint64_t now = wheel.now();
+		assert(!expired[i] && now >= previous);
+		assert(now >= delays[i] && now < delays[i] + tick);
+		expired[i] = true;
+		previous = now;
+		if (delays.size() < expired.size()) {
+			delays.push_back(now + 1000);
+			wheel.schedule(1000, delays.size() - 1);
+		}
+	};
+	while (wheel.size() > 0)
+		wheel.advance(12345, expire);
+	for (std::size_t i = 0; i < expired.size(); i++)
+		assert(expired[i] == (i >= SIZE || i % 3 != 0));
+	assert(!wheel.contains(handles[1]));
+
+	int thrown = 0;
+	try {
+		wheel.cancel(handles[1]);
+	} catch (const std::out_of_range&) {
+		thrown++;
+	}
+	try {
+		wheel.schedule((1 << 20) + 1, 0);
+	} catch (const std::invalid_argument&) {
+		thrown++;
+	}
+	assert(thrown == 2 && wheel.size() == 0);
+}
+
+/*
+ * HashMap has more than one type parameter, so it has its own test instead
+ * of a test_structure specialization.
+ */
+inline void test_hash_map() {
+	structures::HashMap<int, int> map, copy;
+
+	for (int i = 0; i < SIZE; i++) {
+		assert(map.try_emplace(i, 2 * i).second);
+		assert(!map.try_emplace(i, 0).second);
+	}
+
+	assert(map.size() == SIZE);
+	assert(map.find(SIZE) == nullptr);
+
+	copy = map;
+
+	for (int i = 0; i < SIZE; i += 2) {
+		assert(map.remove(i));
+		assert(!map.remove(i));
+	}
+
+	for (int i = 0; i < SIZE; i++) {
+		assert(*copy.find(i) == 2 * i);
+		assert(map.contains(i) == (i % 2 == 1));
+		map[i] += 1;
+		assert(!map.insert_or_assign(i, *map.find(i) + 1).second);
+	}
+
+	for (int i = 0; i < SIZE; i++)
+		assert(map[i] == (i % 2 ? 2 * i + 2 : 2));
+
+	assert(map.items().size() == SIZE);
+	map.clear();
+	assert(map.size() == 0 && !map.contains(0));
+
+	// transparent lookups, without building strings
+	structures::HashMap<
+		std::string, int, structures::StringHash, std::equal_to<>>
+		names;
+	assert(names.insert_or_assign("one", 1).second);
+	names["two"] = 2;
+	std::string_view two{"two"};
+	assert(*names.find(two) == 2);
+	assert(*names.find("one") == 1);
+	assert(!names.contains(std::string_view{"three"}));
+	assert(names.remove(two));
+	assert(names.size() == 1);
+}
+
+/*
+ * RadixHeap has a key and a value type, so it has its own test too.
+ */
+inline void test_radix_heap() {
+	structures::RadixHeap<int, int> pq;
+
+	// events that schedule later events, as in a simulation
+	for (int i = 0; i < SIZE; i++)
+		pq.push((i * 7919) % SIZE - SIZE / 2, i);
+	int previous = -SIZE;
+	for (int i = 0; i < 2 * SIZE; i++) {
+		assert(pq.top().first >= previous);
+		auto event = pq.pop();
+		assert(event.first >= previous);
+		previous = event.first;
+		if (i < SIZE)
+			pq.push(event.first + event.second % 100, event.second);
+	}
+	assert(pq.size() == 0);
+
+	bool thrown = false;
+	pq.push(previous, 0);
+	try {
+		pq.push(previous - 1, 0);
+	} catch (const std::invalid_argument&) {
+		thrown = true;
+	}
+	assert(thrown && pq.size() == 1);
+	pq.clear();
+	assert(pq.size() == 0);
+}
+
+/*
+ * KeyValueHeap has a key and a value type too.
+ */
+inline void test_key_value_heap() {
+	structures::KeyValueHeap<int, std::string> pq;
+	for (int i = 0; i < SIZE; i++) {
+		int key = (i * 7919) % SIZE;
+		pq.push(key, std::to_string(key));
+	}
+
+	// slots of popped values are reused by the next pushes
+	for (int i = SIZE - 1; i >= SIZE / 2; i--) {
+		assert(pq.top_key() == i && pq.top_value() == std::to_string(i));
+		auto top = pq.pop();
+		assert(top.first == i && top.second == std::to_string(i));
+	}
+	for (int i = SIZE / 2; i < SIZE; i++)
+		pq.push({i, std::to_string(i)});
+	for (int i = SIZE - 1; i >= 0; i--)
+		assert(pq.pop().second == std::to_string(i));
+	assert(pq.size() == 0);
+
+	// values are only moved
+	structures::KeyValueHeap<int, std::unique_ptr<int>> owners;
+	for (int i = 0; i < 10; i++)
+		owners.push(i, std::make_unique<int>(i));
+	for (int i = 9; i >= 0; i--)
+		assert(*owners.pop().second == i);
+}
+
+inline void test_hashers() {
+	// keys of every length hash apart, through every path of the functions
+	std::string bytes;
+	structures::HashTableWrapper<std::uint64_t, structures::IntegerHash> wy,
+		xx;
+	for (int i = 0; i < 300; i++) {
+		assert(wy.insert(structures::WyHash{}(bytes)));
+		assert(xx.insert(structures::XXH3Hash{}(bytes)));
+		bytes.push_back(static_cast<char>(i));
+	}
+	assert(structures::wyhash("key", 3) == structures::WyHash{}("key"));
+	assert(structures::xxh3("key", 3) == structures::XXH3Hash{}("key"));
+	assert(structures::wyhash("key", 3, 1) != structures::wyhash("key", 3));
+	assert(structures::IntegerHash{}(0.0) == structures::IntegerHash{}(-0.0));
+
+	// strided keys do not cluster, and every bucket is counted once
+	structures::HashTableWrapper<int, structures::IntegerHash> table;
+	for (int i = 0; i < SIZE; i++)
+		table.insert(i * 1024);
+	auto counts = table.chain_lengths();
+	std::size_t elements = 0;
+	for (std::size_t k = 0; k < counts.size(); k++)
+		elements += k * counts[k];
+	assert(elements == SIZE);
+	assert(counts.size() < 16);
+
+	structures::HashMap<std::string, int, structures::XXH3Hash, std::equal_to<>>
+		map;
+	map["one"] = 1;
+	assert(*map.find(std::string_view{"one"}) == 1);
+}
+
+template <template <typename> class S, template <typename> class F>
+void test_filtered_set() {
+	structures::FilteredSet<int, S, F> set;
+
+	for (int i = 0; i < SIZE; i += 2) {
+		assert(set.insert(i));
+		assert(!set.insert(i));
+	}
+	assert(set.size() == SIZE / 2);
+
+	// the filter has no false negatives, and few false positives
+	std::size_t positives = 0;
+	for (int i = 0; i < SIZE; i++) {
+		assert(set.contains(i) == (i % 2 == 0));
+		assert(i % 2 == 1 || set.filter().contains(i));
+		positives += i % 2 == 1 && set.filter().contains(i);
+	}
+	assert(positives < SIZE / 20);
+
+	for (int i = 0; i < SIZE; i += 4) {
+		assert(set.remove(i));
+		assert(!set.remove(i));
+	}
+	for (int i = 0; i < SIZE; i++) {
+		assert(set.contains(i) == (i % 4 == 2));
+		assert(i % 4 != 2 || set.filter().contains(i));
+	}
+
+	assert(set.items().size() == SIZE / 4);
+	set.clear();
+	assert(set.size() == 0 && !set.contains(2));
+
+	// a moved-from filter is empty, and takes elements again
+	F<int> filter{SIZE};
+	filter.insert(1);
+	F<int> moved{std::move(filter)};
+	assert(moved.contains(1) && !filter.contains(1));
+	filter.clear();
+	assert(filter.insert(1) && filter.contains(1));
+	filter = std::move(moved);
+	assert(filter.contains(1) && !moved.contains(1));
+	moved.clear();
 }
 
 template <template <typename> class S, template <typename> class... Rest>